@@ -20,10 +20,23 @@
 /* lightcjson.c  */
 /* Lightweight JSON parser in C. */
 
+#define _GNU_SOURCE // memmem
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <locale.h>
+#ifndef JSON_NO_THREADS
+#include <pthread.h>
+#endif
 #include "lightcjson.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(LIGHTCJSON_NO_SIMD)
+#include <immintrin.h>
+#define JSON_X86_SIMD
+#endif
+
 #define DOUBLEQUOTE ('\"')
 #define is_space_(x) ( ((x)==' ') || ((x)=='\t') || ((x)=='\n') || ((x)=='\r') )
 #define is_doublequote_(x)   ( (x)==DOUBLEQUOTE )
@@ -32,383 +45,4386 @@
 #define is_bracket_close_(x) ( ((x)==']') || ((x)=='}') )
 #define is_number_(x)        ( ((x)>='0') && ((x)<='9') )
 
+// ---- hot-path counters ----
+// built with -DLIGHTCJSON_STATS each thread counts its own work, read with
+// jsonStatsSnapshot(). without it json_stat_ compiles to nothing.
+
+#ifdef LIGHTCJSON_STATS
+static __thread jsonStats json_stats;
+#define json_stat_(field, n) (json_stats.field += (n))
+#else
+#define json_stat_(field, n) ((void)sizeof(n))
+#endif
+#define json_strlen_(s) (json_stat_(strlen_calls, 1), strlen(s))
+
+void jsonStatsSnapshot(jsonStats *stats) {
+#ifdef LIGHTCJSON_STATS
+  *stats = json_stats;
+#else
+  memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+void jsonStatsReset(void) {
+#ifdef LIGHTCJSON_STATS
+  memset(&json_stats, 0, sizeof(json_stats));
+#endif
+}
+
+// ---- structural scanner ----
+// classifies 32 byte blocks into bitmasks (bit n = byte n of the block)
+// with AVX2, SSE2 or plain C, picked on first use.
+
+#define JSON_BLOCK 32
+#define JSON_SCAN_QUOTE  1
+#define JSON_SCAN_ESCAPE 2
+#define JSON_SCAN_SPACE  4
+#define JSON_SCAN_STRUCT 8 // {}[],:
+#define JSON_SCAN_CONTROL 16 // bytes below 0x20, which strings must escape
+#define JSON_SCAN_HIGH 32 // bytes 0x80 and up, parts of UTF-8 sequences
+#define JSON_SCAN_DIGIT 64 // 0-9
+
+#ifdef __GNUC__
+#define json_ctz_(x) __builtin_ctz(x)
+#define json_top_(x) (63 - __builtin_clzll(x))
+#else
+static int json_ctz_(uint32_t x) { int n=0; while (!(x&1)) { x>>=1; n++; } return n; }
+static int json_top_(uint64_t x) { int n=-1; while (x) { x>>=1; n++; } return n; }
+#endif
+
+// xor of all bits at or below each position: 1 = odd number of set bits so far
+static uint32_t json_prefix_xor(uint32_t x) {
+  x ^= x << 1; x ^= x << 2; x ^= x << 4; x ^= x << 8; x ^= x << 16;
+  return x;
+}
+
+// bytes escaped by a backslash: the one after each odd-length run.
+// *carry: first byte of this block is escaped in / of the next block out
+static uint32_t json_escaped(uint32_t backslash, uint32_t *carry) {
+  const uint32_t even = 0x55555555;
+  backslash &= ~*carry;
+  uint32_t follows = (backslash << 1) | *carry;
+  uint32_t odd_starts = backslash & ~even & ~follows;
+  uint32_t seq = odd_starts + backslash;
+  *carry = seq < backslash; // run reaches the end of the block
+  return (even ^ (seq << 1)) & follows;
+}
+
+typedef struct {
+  uint32_t quote, escape, space, structural, control, high, digit;
+} json_block_t;
+
+// sixteen equal table entries, tables are written out without range designators
+#define json_row_(x) x, x, x, x, x, x, x, x, x, x, x, x, x, x, x, x
+
+static const unsigned char json_class[256] = {
+  // 0x00-0x1f: controls, \t \n \r are spacing too
+  JSON_SCAN_CONTROL, JSON_SCAN_CONTROL, JSON_SCAN_CONTROL, JSON_SCAN_CONTROL, 
+  JSON_SCAN_CONTROL, JSON_SCAN_CONTROL, JSON_SCAN_CONTROL, JSON_SCAN_CONTROL, 
+  JSON_SCAN_CONTROL, JSON_SCAN_SPACE|JSON_SCAN_CONTROL, JSON_SCAN_SPACE|JSON_SCAN_CONTROL, 
+  JSON_SCAN_CONTROL, JSON_SCAN_CONTROL, JSON_SCAN_SPACE|JSON_SCAN_CONTROL, 
+  JSON_SCAN_CONTROL, JSON_SCAN_CONTROL, 
+  json_row_(JSON_SCAN_CONTROL),
+  ['"']=JSON_SCAN_QUOTE, ['\\']=JSON_SCAN_ESCAPE, [' ']=JSON_SCAN_SPACE,
+  ['{']=JSON_SCAN_STRUCT, ['}']=JSON_SCAN_STRUCT, ['[']=JSON_SCAN_STRUCT, [']']=JSON_SCAN_STRUCT,
+  [',']=JSON_SCAN_STRUCT, [':']=JSON_SCAN_STRUCT,
+  ['0']=JSON_SCAN_DIGIT, ['1']=JSON_SCAN_DIGIT, ['2']=JSON_SCAN_DIGIT, ['3']=JSON_SCAN_DIGIT,
+  ['4']=JSON_SCAN_DIGIT, ['5']=JSON_SCAN_DIGIT, ['6']=JSON_SCAN_DIGIT, ['7']=JSON_SCAN_DIGIT,
+  ['8']=JSON_SCAN_DIGIT, ['9']=JSON_SCAN_DIGIT,
+  // 0x80-0xff
+  [0x80]=json_row_(JSON_SCAN_HIGH), json_row_(JSON_SCAN_HIGH), json_row_(JSON_SCAN_HIGH), 
+  json_row_(JSON_SCAN_HIGH), json_row_(JSON_SCAN_HIGH), json_row_(JSON_SCAN_HIGH), 
+  json_row_(JSON_SCAN_HIGH), json_row_(JSON_SCAN_HIGH)
+};
+#define json_class_(x) (json_class[(unsigned char)(x)])
+
+static uint32_t json_block_select(const json_block_t *m, int classes) {
+  uint32_t hits = 0;
+  if (classes & JSON_SCAN_QUOTE)  hits |= m->quote;
+  if (classes & JSON_SCAN_ESCAPE) hits |= m->escape;
+  if (classes & JSON_SCAN_SPACE)  hits |= m->space;
+  if (classes & JSON_SCAN_STRUCT) hits |= m->structural;
+  if (classes & JSON_SCAN_CONTROL) hits |= m->control;
+  if (classes & JSON_SCAN_HIGH) hits |= m->high;
+  if (classes & JSON_SCAN_DIGIT) hits |= m->digit;
+  return hits;
+}
+
+static void json_classify_c(const char *p, json_block_t *m) {
+  int i;
+  m->quote = m->escape = m->space = m->structural = m->control = m->high = m->digit = 0;
+  for (i=0; i<JSON_BLOCK; i++) {
+    uint32_t bit = (uint32_t)1 << i;
+    int c = json_class_(p[i]);
+    if (c & JSON_SCAN_QUOTE)   m->quote |= bit;
+    if (c & JSON_SCAN_ESCAPE)  m->escape |= bit;
+    if (c & JSON_SCAN_SPACE)   m->space |= bit;
+    if (c & JSON_SCAN_STRUCT)  m->structural |= bit;
+    if (c & JSON_SCAN_CONTROL) m->control |= bit;
+    if (c & JSON_SCAN_HIGH)    m->high |= bit;
+    if (c & JSON_SCAN_DIGIT)   m->digit |= bit;
+  }
+}
+
+#ifdef JSON_X86_SIMD
+// brackets: ({ | 0x20)==0x7b covers { and [, (} | 0x20)==0x7d covers } and ]
+// controls: min(v, 0x1f)==v for bytes below 0x20, high bytes: the sign bit,
+// digits: min(v-'0', 9)==v-'0'
+__attribute__((target("sse2")))
+static void json_classify_sse2(const char *p, json_block_t *m) {
+  int half;
+  m->quote = m->escape = m->space = m->structural = m->control = m->high = m->digit = 0;
+  for (half=0; half<2; half++) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(p + 16*half));
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i space = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+    __m128i structural = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8(0x7b)), _mm_cmpeq_epi8(lower, _mm_set1_epi8(0x7d))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')), _mm_cmpeq_epi8(v, _mm_set1_epi8(':'))));
+    int shift = 16*half;
+    m->quote |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << shift;
+    m->escape |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << shift;
+    m->space |= (uint32_t)_mm_movemask_epi8(space) << shift;
+    m->structural |= (uint32_t)_mm_movemask_epi8(structural) << shift;
+    m->control |= (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v)) << shift;
+    m->high |= (uint32_t)_mm_movemask_epi8(v) << shift;
+    __m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    m->digit |= (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit)) << shift;
+  }
+}
+
+__attribute__((target("avx2")))
+static void json_classify_avx2(const char *p, json_block_t *m) {
+  __m256i v = _mm256_loadu_si256((const __m256i *)p);
+  __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+  __m256i space = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+  __m256i structural = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8(0x7b)), _mm256_cmpeq_epi8(lower, _mm256_set1_epi8(0x7d))),
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(':'))));
+  m->quote = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+  m->escape = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+  m->space = (uint32_t)_mm256_movemask_epi8(space);
+  m->structural = (uint32_t)_mm256_movemask_epi8(structural);
+  m->control = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v));
+  m->high = (uint32_t)_mm256_movemask_epi8(v);
+  __m256i digit = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+  m->digit = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit));
+}
+#endif
+
+#ifdef JSON_X86_SIMD
+// runtime CPU dispatch, chosen once when the library is loaded, before any
+// thread can scan; until then the portable version is used
+static void (*json_classify)(const char *p, json_block_t *m) = json_classify_c;
+
+__attribute__((constructor))
+static void json_classify_init(void) {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) json_classify = json_classify_avx2;
+  else if (__builtin_cpu_supports("sse2")) json_classify = json_classify_sse2;
+}
+#else
+#define json_classify json_classify_c
+#endif
+
+// first byte in [p, end) of one of the given classes, or end
+static const char *json_scan(const char *p, const char *end, int classes) {
+  json_block_t m;
+  while (end-p >= JSON_BLOCK) {
+    json_classify(p, &m);
+    json_stat_(bytes_scanned, JSON_BLOCK);
+    uint32_t hits = json_block_select(&m, classes);
+    if (hits) return p + json_ctz_(hits);
+    p += JSON_BLOCK;
+  }
+  const char *start = p;
+  while ((p<end) && !(json_class_(*p) & classes)) p++;
+  json_stat_(bytes_scanned, p-start);
+  return p;
+}
+
+// first unescaped quote in [p, end) (not after an odd run of backslashes
+// since p), or end
+static const char *json_scan_quote(const char *p, const char *end) {
+  const char *start = p;
+  while (1) {
+    const char *q = json_scan(p, end, JSON_SCAN_QUOTE);
+    if (q>=end) return q;
+    const char *esc = q;
+    while ((esc>start) && is_escape_(esc[-1])) esc--;
+    if (!((q-esc) & 1)) return q;
+    p = q+1;
+  }
+}
+
+// type of an unquoted word: number, true, false, null or unknown
+static jsonType json_word_type(const char *word, int len) {
+  if (is_number_(*word) || (*word=='-')) return JSON_NUMBER;
+  if ((len==4) && (memcmp(word, "true", 4)==0)) return JSON_TRUE;
+  if ((len==5) && (memcmp(word, "false", 5)==0)) return JSON_FALSE;
+  if ((len==4) && (memcmp(word, "null", 4)==0)) return JSON_NULL;
+  return JSON_NONE;
+}
+
+// type of the value starting at ptr
+static jsonType json_value_type(const char *ptr, size_t len) {
+  if (!len) return JSON_NONE;
+  if (*ptr=='{') return JSON_OBJECT;
+  if (*ptr=='[') return JSON_ARRAY;
+  if (is_doublequote_(*ptr)) return JSON_STRING;
+  return json_word_type(ptr, len);
+}
+
 // trim beginning & end unnecessary spacing
-char *jsonTrim(const char *src, char *dest) {
-  char *ptr = dest;
-  char *input = (char *)src;
+char *jsonTrimN(const char *src, size_t len, char *dest) {
+  const char *input = src, *end = src + len;
   // beginning
-  while (*input) {
-    if (!is_space_(*input)) break;
-    input++;
-  }
-  while (*input) {
-    *dest=*input; dest++; input++;
-  }
-  *dest = '\0';
-  dest--; // cleanup from behind
-  while (dest>=ptr) {
-    if (!is_space_(*dest)) {
-      *(dest+1) = '\0';
-      break;
+  while ((input<end) && is_space_(*input)) input++;
+  // end
+  while ((end>input) && is_space_(end[-1])) end--;
+  memmove(dest, input, end-input);
+  json_stat_(bytes_copied, end-input);
+  dest[end-input] = '\0';
+  return dest;
+}
+
+char *jsonTrim(const char *src, char *dest) {
+  return jsonTrimN(src, json_strlen_(src), dest);
+}
+
+// remove spacing from json[0..len) into dest (may be json), returns length.
+// *in_string / *escaped carry the state before and after, so input can be
+// fed in pieces split anywhere
+static size_t json_remove_spacing(const char *json, size_t len, char *dest,
+    int *in_string, int *escaped) {
+  const char *input = json, *end = json + len;
+  char *out = dest;
+  uint32_t string_mask = (*in_string) ? 0xffffffff : 0; // all ones while inside a string
+  uint32_t carry = *escaped; // first byte of the block is escaped
+  json_block_t m;
+
+  while (end-input >= JSON_BLOCK) {
+    json_classify(input, &m);
+    json_stat_(bytes_scanned, JSON_BLOCK);
+    uint32_t toggles = m.quote & ~json_escaped(m.escape, &carry);
+    uint32_t inside = json_prefix_xor(toggles) ^ string_mask;
+    uint32_t drop = m.space & ~inside;
+    string_mask = (inside >> 31) ? 0xffffffff : 0;
+
+    if (!drop) { // nothing to remove, move block as is
+      if (out!=input) memmove(out, input, JSON_BLOCK);
+      out += JSON_BLOCK;
+    } else { // copy runs between removed bytes
+      int i = 0;
+      while (drop) {
+        int d = json_ctz_(drop);
+        if (d>i) { memmove(out, input+i, d-i); out += d-i; }
+        i = d+1;
+        drop &= drop-1;
+      }
+      if (i<JSON_BLOCK) { memmove(out, input+i, JSON_BLOCK-i); out += JSON_BLOCK-i; }
     }
-    dest--;
+    input += JSON_BLOCK;
   }
-  return ptr;
+
+  // remaining bytes one at a time, same rules as the blocks
+  int inside = string_mask & 1, esc = carry;
+  while (input<end) {
+    char ch = *input++;
+    if (esc) esc = 0;
+    else if (is_escape_(ch)) esc = 1;
+    else if (is_doublequote_(ch)) inside = !inside;
+    if (!inside && is_space_(ch)) continue;
+    *out++ = ch;
+  }
+  *in_string = inside;
+  *escaped = esc;
+  json_stat_(bytes_copied, out - dest);
+  return out - dest;
 }
 
 // remove all unnecessary spacing from the JSON string... preserving strings
 // dest can = json to save space. 
 // returns pointer to jsonOutput.
 // dest must have at least the same space as json
+char *jsonRemoveSpacingN(const char *json, size_t len, char *dest) {
+  int in_string = 0, escaped = 0;
+  dest[json_remove_spacing(json, len, dest, &in_string, &escaped)] = '\0';
+  return dest;
+}
+
 char *jsonRemoveSpacing(const char *json, char *dest) {
-  int quote_count = 0;
-  char *ptr = dest; // keep pointer to start of output
-  char prev = 0;
-  char *input = (char *)json;
-
-  while (*input) {
-    char ch = *input;
-    // is it spacing?
-    if (is_space_(ch)) {
-        if (quote_count % 2) { // inside a string: keep
-          *dest = ch; 
-          dest++;
+  return jsonRemoveSpacingN(json, json_strlen_(json), dest);
+}
+
+
+// end of the string whose opening quote is just before ptr (past closing quote)
+// a quote closes the string if an even number of backslashes precede it
+static const char *json_string_end(const char *ptr, const char *end) {
+  const char *start = ptr;
+  while ((ptr<end) && (ptr = memchr(ptr, DOUBLEQUOTE, end-ptr))) {
+    const char *esc = ptr;
+    while ((esc>start) && is_escape_(esc[-1])) esc--;
+    if (!((ptr-esc) & 1)) return ptr+1;
+    ptr++;
+  }
+  return end;
+}
+
+// end of the value starting at ptr (first byte after it)
+// strings are skipped as a whole, so brackets in them do not count
+static const char *json_value_end(const char *ptr, const char *end) {
+  if (ptr>=end) return end;
+  if (is_doublequote_(*ptr)) return json_string_end(ptr+1, end);
+  if (is_bracket_open_(*ptr)) {
+    // walk all hits of a block from one classification; only a string
+    // running past the block restarts it
+    int level = 0, i;
+    while (ptr<end) {
+      const char *next = (end-ptr >= JSON_BLOCK) ? ptr + JSON_BLOCK : end;
+      uint32_t hits = 0;
+      json_stat_(bytes_scanned, next-ptr);
+      if (next-ptr==JSON_BLOCK) {
+        json_block_t m;
+        json_classify(ptr, &m);
+        hits = m.quote | m.structural;
+      } else {
+        for (i=0; i<next-ptr; i++) {
+          if (json_class_(ptr[i]) & (JSON_SCAN_QUOTE | JSON_SCAN_STRUCT)) hits |= (uint32_t)1 << i;
         }
-    } else {
-      if (is_doublequote_(ch)) { // is double quote?
-          if (!is_escape_(prev)) { // if not escaped, count it
-            quote_count++;
-          }
       }
-      *dest = ch; 
-      dest++;
+      while (hits) {
+        const char *hit = ptr + json_ctz_(hits);
+        hits &= hits-1;
+        if (is_doublequote_(*hit)) {
+          const char *string_end = json_string_end(hit+1, end);
+          if (string_end>=next) { next = string_end; break; }
+          hits &= ~(((uint32_t)1 << (string_end-ptr)) - 1); // hits inside the string
+          continue;
+        }
+        if (is_bracket_open_(*hit)) level++;
+        else if (is_bracket_close_(*hit) && (--level==0)) return hit+1;
+      }
+      ptr = next;
     }
-    prev = ch;
-    input++;
+    return end;
   }
-  *dest = 0;
+  while ((ptr<end) && !(json_class_(*ptr) & (JSON_SCAN_SPACE | JSON_SCAN_STRUCT | JSON_SCAN_QUOTE))) ptr++;
   return ptr;
 }
 
+// ---- cursors ----
+// a cursor keeps its place in a list or object, so walking all members
+// costs one pass instead of a rescan per member.
 
-// retrieve item in indexed list; trims unnecessary space start/end
-// eg .
-char *jsonIndexList(const char *json, int index, char *dest, int size) {
-  int level = 1; // number of braces seen { = +1 } = -1
-  int item_idx = 0;
-  char *input = (char *)json;
-  char *ptr_start = input;
-  char ch;
-
-  while (level>0) {
-    ch = *input;
-    //printf("[%c,%d,%d,%d]", ch,level,item_idx,(ptr_start-json));
-    if (is_bracket_close_(ch)) level--;
-    if (is_bracket_open_(ch)) level++;
-
-    if (level==1) {
-      if (ch==',' || is_bracket_close_(ch) || ch=='\0') {
-        if (item_idx==index) { // got it 
-          int len = input - ptr_start;
-          if (is_bracket_close_(ch)) len++; // include closing bracket
-          if (len>=size) len=size-1;
-          strncpy(dest, ptr_start, len);
-          *(dest+len)='\0'; // terminate string
-          jsonTrim(dest, dest);
-          return dest;
-        } else if (!is_bracket_close_(ch)) {
-          item_idx++;
-          ptr_start = input+1;
-        }
-      }
+// cursor over a body (the part between the brackets) ending at end
+static void json_cursor_body(jsonCursor *cursor, const char *json, size_t pos, 
+    size_t end, int depth) {
+  cursor->json = json;
+  cursor->pos = pos;
+  cursor->end = end;
+  cursor->depth = depth;
+  cursor->count = 0;
+  cursor->walk = 0;
+  cursor->open = 0;
+  cursor->parent = NULL;
+}
+
+// an open member not entered, or left early, is skipped here
+static const char *json_cursor_skip(jsonCursor *cursor) {
+  const char *json = cursor->json;
+  if (cursor->open==1) cursor->pos = json_value_end(json + cursor->pos, json + cursor->end) - json;
+  cursor->open = 0;
+  return json + cursor->pos;
+}
+
+// exact span of the member just returned
+static void json_cursor_close(jsonCursor *cursor, jsonSpan *span) {
+  if (cursor->open!=1) return;
+  span->len = json_cursor_skip(cursor) - (cursor->json + span->offset);
+  cursor->open = 2; // rest of a list item still to skip
+}
+
+// the body ended at pos: an entered cursor hands its end to the parent,
+// if that is still at this list or object
+static void json_cursor_done(jsonCursor *cursor) {
+  jsonCursor *parent = cursor->parent;
+  if (parent && (parent->open==1) && (parent->pos<cursor->pos) && (cursor->pos<cursor->end) &&
+      is_bracket_close_(cursor->json[cursor->pos])) {
+    parent->pos = cursor->pos + 1;
+    parent->open = 2;
+  }
+}
+
+// start iterating the list json[0..len); returns 1=ok, 0=not a list
+int jsonListInit(jsonCursor *cursor, const char *json, size_t len) {
+  const char *ptr = json, *end = json + len;
+  while ((ptr<end) && is_space_(*ptr)) ptr++;
+  json_cursor_body(cursor, json, ptr+1-json, len, 1);
+  if ((ptr>=end) || (*ptr!='[')) { cursor->pos = len; return 0; }
+  return 1;
+}
+
+// rest of the list item at ptr: returns the start of the next one, item_end
+// gets the end of this one without its spacing
+static const char *json_list_rest(const char *ptr, const char *end, const char **item_end) {
+  *item_end = ptr;
+  while ((ptr<end) && is_space_(*ptr)) ptr++;
+  while ((ptr<end) && (*ptr!=',') && !is_bracket_close_(*ptr)) {
+    const char *next = json_value_end(ptr, end);
+    ptr = (next>ptr) ? next : ptr+1; // stray ':' and the like
+    *item_end = ptr;
+    while ((ptr<end) && is_space_(*ptr)) ptr++;
+  }
+  if ((ptr<end) && (*ptr==',')) ptr++;
+  return ptr;
+}
+
+// next list item, span excludes spacing at start/end
+// strings and nested values are skipped whole, so brackets and commas
+// in them do not count. returns 1=item, 0=end of list
+int jsonListNext(jsonCursor *cursor, jsonSpan *span) {
+  const char *json = cursor->json, *end = json + cursor->end;
+  const char *ptr = json + cursor->pos, *item_end;
+
+  if (cursor->open) ptr = json_list_rest(json_cursor_skip(cursor), end, &item_end);
+  while ((ptr<end) && is_space_(*ptr)) ptr++;
+  cursor->pos = ptr - json;
+  if ((ptr>=end) || is_bracket_close_(*ptr)) {
+    json_cursor_done(cursor);
+    return 0;
+  }
+  cursor->count++;
+  span->offset = ptr - json;
+  if (cursor->walk && is_bracket_open_(*ptr)) {
+    cursor->open = 1;
+    span->len = end - ptr;
+  } else {
+    cursor->pos = json_list_rest(ptr, end, &item_end) - json;
+    span->len = item_end - ptr;
+  }
+  span->type = json_value_type(ptr, span->len);
+  return 1;
+}
+
+// next list item copied to dest, NULL at end of list
+char *jsonListNextItem(jsonCursor *cursor, char *dest, int size) {
+  jsonSpan span;
+  if (!jsonListNext(cursor, &span)) {
+    if (size>0) *dest = '\0';
+    return NULL;
+  }
+  json_cursor_close(cursor, &span);
+  return jsonSpanCopy(cursor->json, &span, dest, size);
+}
+
+// start iterating the object json[0..len); returns 1=ok, 0=not an object
+int jsonObjectInit(jsonCursor *cursor, const char *json, size_t len) {
+  const char *ptr = json, *end = json + len;
+  while ((ptr<end) && is_space_(*ptr)) ptr++;
+  json_cursor_body(cursor, json, ptr+1-json, len, 1);
+  if ((ptr>=end) || (*ptr!='{')) { cursor->pos = len; return 0; }
+  return 1;
+}
+
+// next object member: key span is the name between the quotes (still
+// escaped), value span the whole value, empty if it is missing.
+// returns 1=member, 0=end of object or broken JSON
+int jsonObjectNext(jsonCursor *cursor, jsonSpan *key, jsonSpan *value) {
+  const char *json = cursor->json, *end = json + cursor->end;
+  const char *ptr = json_cursor_skip(cursor), *name, *value_end;
+
+  while ((ptr<end) && (is_space_(*ptr) || (*ptr==','))) ptr++;
+  cursor->pos = ptr - json;
+  if ((ptr>=end) || !is_doublequote_(*ptr)) {
+    json_cursor_done(cursor);
+    return 0;
+  }
+  name = ptr+1;
+  ptr = json_string_end(name, end);
+  if ((ptr<=name) || !is_doublequote_(ptr[-1])) return 0; // unterminated
+  key->offset = name - json;
+  key->len = ptr - 1 - name;
+  key->type = JSON_STRING;
+  while ((ptr<end) && is_space_(*ptr)) ptr++;
+  if ((ptr>=end) || (*ptr!=':')) return 0;
+  ptr++;
+  while ((ptr<end) && is_space_(*ptr)) ptr++;
+  if (cursor->walk && (ptr<end) && is_bracket_open_(*ptr)) {
+    value_end = end;
+    cursor->pos = ptr - json;
+    cursor->open = 1;
+  } else {
+    value_end = json_value_end(ptr, end);
+    cursor->pos = value_end - json;
+  }
+  value->offset = ptr - json;
+  value->len = value_end - ptr;
+  value->type = json_value_type(ptr, value->len);
+  cursor->count++;
+  return 1;
+}
+
+// cursor over a list or object value found by cursor (e.g. a member value);
+// walked to its end, it moves cursor past the value.
+// returns 1=ok, 0=value is not a list or object
+int jsonCursorEnter(jsonCursor *cursor, const jsonSpan *value, jsonCursor *child) {
+  if ((value->type!=JSON_OBJECT) && (value->type!=JSON_ARRAY)) return 0;
+  json_cursor_body(child, cursor->json, value->offset+1, value->offset+value->len, 
+      cursor->depth+1);
+  child->walk = cursor->walk;
+  child->parent = cursor;
+  return 1;
+}
+
+// locate item in indexed list (a list body without brackets, "1, 2, 3");
+// span excludes spacing at start/end. returns 1=found, 0=no such item
+int jsonIndexListSpan(const char *json, size_t json_len, int index, jsonSpan *span) {
+  jsonCursor cursor;
+  json_cursor_body(&cursor, json, 0, json_len, 1);
+  while (jsonListNext(&cursor, span)) {
+    if (cursor.count-1==index) {
+      json_cursor_close(&cursor, span);
+      return 1;
     }
-    if (ch=='\0') break;
-    input++;
   }
-  *dest = '\0';
-  return NULL;
+  return 0;
 }
 
-// return a sub-json struct
-char *jsonExtract(const char *json, const char *key_name, char *dest, int size) {
-  char *ptr_start, *ptr_end;
-  char name[strlen(key_name)+3];
+// retrieve item in indexed list; trims unnecessary space start/end
+char *jsonIndexListN(const char *json, size_t json_len, int index, char *dest, int size) {
+  jsonSpan span;
+  if (!jsonIndexListSpan(json, json_len, index, &span)) {
+    if (size>0) *dest = '\0';
+    return NULL;
+  }
+  return jsonSpanCopy(json, &span, dest, size);
+}
 
-  snprintf(name, sizeof(name), "\"%s\"", key_name);
-  //printf("Searching for '%s'\n", name);
+char *jsonIndexList(const char *json, int index, char *dest, int size) {
+  return jsonIndexListN(json, json_strlen_(json), index, dest, size);
+}
 
-  ptr_start = strstr(json, name);
-  if (!ptr_start) { // not found at all
-    dest='\0'; return NULL;
+// first occurrence of "key_name" (with quotes) in json[0..len), or NULL
+static const char *json_find_name(const char *json, size_t len, 
+    const char *key_name, size_t name_len) {
+  json_stat_(key_searches, 1);
+#ifdef __GLIBC__
+  char name[name_len+2];
+  name[0] = DOUBLEQUOTE;
+  memcpy(name+1, key_name, name_len);
+  name[name_len+1] = DOUBLEQUOTE;
+  return memmem(json, len, name, name_len+2);
+#else
+  const char *ptr = json, *end = json + len;
+  while ((size_t)(end-ptr) >= name_len+2) {
+    ptr = memchr(ptr, DOUBLEQUOTE, end-ptr-name_len-1);
+    if (!ptr) return NULL;
+    if ((memcmp(ptr+1, key_name, name_len)==0) && is_doublequote_(ptr[name_len+1])) return ptr;
+    ptr++;
   }
-  ptr_start += strlen(name) + 1; // include : after key
-  //printf("\nRest: %s\n", ptr_start);
+  return NULL;
+#endif
+}
+
+// locate a sub-json struct, span is empty if the key has no value
+// returns 1=found, 0=not found or value of unknown type
+int jsonExtractSpan(const char *json, size_t json_len, const char *key_name, 
+    jsonSpan *span) {
+  const char *ptr_start, *ptr_end;
+  const char *end = json + json_len;
+  size_t name_len = json_strlen_(key_name);
+
+  ptr_start = json_find_name(json, json_len, key_name, name_len);
+  if (!ptr_start) return 0; // not found at all
+  ptr_start += name_len + 3; // include : after key
+  if (ptr_start>end) ptr_start = end;
 
   // skip spaces
-  while (*ptr_start && is_space_(*ptr_start)) ptr_start++;
-  if (!*ptr_start) {
-    *dest = '\0'; return dest;
-  }
+  while ((ptr_start<end) && is_space_(*ptr_start)) ptr_start++;
+  span->offset = ptr_start - json;
+  span->len = 0;
+  span->type = JSON_NONE;
+  if (ptr_start>=end) return 1;
   ptr_end = ptr_start;
 
   // options: number, quote, [list], {struct}
   if (is_number_(*ptr_start) || (*ptr_start=='-')) { // number
     ptr_end = ptr_start+1;
-    while (*ptr_end && (is_number_(*ptr_end) || (*ptr_end=='.'))) ptr_end++;
+    while ((ptr_end<end) && (is_number_(*ptr_end) || (*ptr_end=='.'))) ptr_end++;
+    if ((ptr_end<end) && ((*ptr_end=='e') || (*ptr_end=='E'))) { // exponent
+      const char *exp = ptr_end+1;
+      if ((exp<end) && ((*exp=='+') || (*exp=='-'))) exp++;
+      if ((exp<end) && is_number_(*exp)) {
+        ptr_end = exp;
+        while ((ptr_end<end) && is_number_(*ptr_end)) ptr_end++;
+      }
+    }
 
   } else if (is_doublequote_(*ptr_start)) { // string
-    ptr_end = ptr_start+1;
-    char prev = *ptr_start;
-    while (*ptr_end) {
-      if (is_doublequote_(*ptr_end) && (!is_escape_(prev))) break;
-      prev = *ptr_end; ptr_end++;
-    }
-    if (*ptr_end) ptr_end++;
+    ptr_end = json_scan_quote(ptr_start+1, end);
+    if (ptr_end<end) ptr_end++;
 
   } else if (is_bracket_open_(*ptr_start)) { // struct or list
-    ptr_end = ptr_start+1;
-    char prev = *ptr_start;
     int level = 0;
-    while (*ptr_end) {
-      if (is_doublequote_(*ptr_end) && (!is_escape_(prev))) {
-        ptr_end++;
-        while (*ptr_end) { // spool through string
-          if (is_doublequote_(*ptr_end) && (!is_escape_(prev))) break;
-          prev = *ptr_end; ptr_end++;
-        }
-        if (!(*ptr_end)) break;
+    ptr_end = ptr_start+1;
+    while (1) { // jump between quotes and brackets
+      ptr_end = json_scan(ptr_end, end, JSON_SCAN_QUOTE | JSON_SCAN_STRUCT);
+      if (ptr_end>=end) break;
+      if (is_escape_(ptr_end[-1])) { ptr_end++; continue; }
+      if (is_doublequote_(*ptr_end)) { // spool through string
+        ptr_end = json_scan_quote(ptr_end+1, end);
+        if (ptr_end>=end) break;
       }
-      if (is_bracket_open_(*ptr_end) && (!is_escape_(prev))) level++;
-      if (is_bracket_close_(*ptr_end) && (!is_escape_(prev))) level--;
+      if (is_bracket_open_(*ptr_end)) level++;
+      if (is_bracket_close_(*ptr_end)) level--;
       if (level<0) break;
-      prev = *ptr_end; ptr_end++;
+      ptr_end++;
+    }
+    if (ptr_end<end) ptr_end++;
+
+  } else { // true, false, null or give up
+    while ((ptr_end<end) && (*ptr_end>='a') && (*ptr_end<='z')) ptr_end++;
+    if (json_word_type(ptr_start, ptr_end - ptr_start)==JSON_NONE) return 0;
+  }
+  span->len = ptr_end - ptr_start;
+  span->type = json_value_type(ptr_start, span->len);
+  return 1;
+}
+
+// return a sub-json struct
+char *jsonExtractN(const char *json, size_t json_len, const char *key_name, 
+    char *dest, int size) {
+  jsonSpan span;
+  if (!jsonExtractSpan(json, json_len, key_name, &span)) {
+    if (size>0) *dest = '\0';
+    return NULL;
+  }
+  return jsonSpanCopy(json, &span, dest, size);
+}
+
+// find several keys in one pass over json; spans[i] receives the value of
+// keys[i], keys that are not found get type JSON_NONE. like jsonExtract the
+// first occurrence at any depth counts, but strings are never taken as keys.
+// returns number of keys found, -1 for over JSON_MANY_MAX_KEYS keys.
+// blocks are classified once and carry the string state, so only structural
+// bytes outside strings are visited and a value ends at the next one. a
+// colon looks up the string before it in buckets by length and first byte,
+// which compares a name only with the keys it could be; the scan stops once
+// every key is found and every value found has ended
+#define JSON_MANY_BUCKETS 64
+#define json_many_bucket_(name, len) ((((len) ? (unsigned char)(name)[0] : 0) + (len)*4) & (JSON_MANY_BUCKETS-1))
+
+// end span at stop, without the spaces before it
+static void json_many_close(const char *json, jsonSpan *span, const char *stop) {
+  while ((stop>json+span->offset) && is_space_(stop[-1])) stop--;
+  span->len = stop - (json+span->offset);
+  span->type = json_value_type(json+span->offset, span->len);
+}
+
+int jsonExtractMany(const char *json, size_t json_len, const char **keys, 
+    jsonSpan *spans, int count) {
+  const char *ptr = json, *end = json + json_len;
+  size_t key_len[JSON_MANY_MAX_KEYS];
+  int same_as[JSON_MANY_MAX_KEYS]; // earlier entry with the same key, or -1
+  int chain[JSON_MANY_MAX_KEYS];   // next key in the same bucket, or -1
+  int open[JSON_MANY_MAX_KEYS];    // keys whose container value is not closed yet
+  long open_depth[JSON_MANY_MAX_KEYS];
+  int bucket[JSON_MANY_BUCKETS];
+  int i, j, pending = 0, open_count = 0, scalar = -1; // scalar: value not ended yet
+  long depth = 0;
+  uint32_t carry = 0, string_mask = 0;
+  uint64_t quotes = 0; // string toggles of the previous and this block
+  char tail[JSON_BLOCK];
+  json_block_t m;
+
+  if (count>JSON_MANY_MAX_KEYS) return -1;
+  memset(bucket, 0xff, sizeof(bucket)); // all -1
+  for (i=0; i<count; i++) {
+    key_len[i] = json_strlen_(keys[i]);
+    spans[i].offset = 0; spans[i].len = 0; spans[i].type = JSON_NONE;
+    int b = json_many_bucket_(keys[i], key_len[i]);
+    for (j=bucket[b]; j>=0; j=chain[j]) { // a repeated key shares the first one
+      if ((key_len[j]==key_len[i]) && (memcmp(keys[i], keys[j], key_len[i])==0)) break;
     }
-    if (*ptr_end) ptr_end++;
+    same_as[i] = j;
+    if (j>=0) continue;
+    chain[i] = bucket[b];
+    bucket[b] = i;
+    pending++;
+  }
 
-  } else { // undefined type, give up
-    dest='\0'; return NULL;
+  while ((ptr<end) && (pending || open_count || (scalar>=0))) {
+    const char *block = ptr;
+    size_t n = end - ptr;
+    if (n<JSON_BLOCK) { // last block, padded with spaces
+      memset(tail, ' ', JSON_BLOCK);
+      memcpy(tail, ptr, n);
+      block = tail;
+    } else n = JSON_BLOCK;
+    json_classify(block, &m);
+    json_stat_(bytes_scanned, n);
+    uint32_t toggles = m.quote;
+    if (m.escape | carry) toggles &= ~json_escaped(m.escape, &carry);
+    uint32_t inside = json_prefix_xor(toggles) ^ string_mask;
+    uint32_t hits = m.structural & ~inside;
+    string_mask = (inside >> 31) ? 0xffffffff : 0;
+    quotes = (quotes >> JSON_BLOCK) | ((uint64_t)toggles << JSON_BLOCK);
+
+    while (hits) {
+      const char *hit = ptr + json_ctz_(hits);
+      hits &= hits-1;
+      if (scalar>=0) { // a scalar or string value ends at the next structural byte
+        json_many_close(json, &spans[scalar], hit);
+        scalar = -1;
+      }
+      if (is_bracket_open_(*hit)) { depth++; continue; }
+      if (is_bracket_close_(*hit)) {
+        depth--;
+        for (i=0; i<open_count; i++) { // containers found as values end here
+          if (open_depth[i]!=depth) continue;
+          int k = open[i];
+          spans[k].len = hit+1 - (json + spans[k].offset);
+          open[i] = open[--open_count];
+          open_depth[i--] = open_depth[open_count];
+        }
+        continue;
+      }
+      if ((*hit!=':') || !pending) continue;
+
+      // the name is the string right before the colon. its quotes are the
+      // last two toggles of this and the previous block, a name reaching
+      // further back is found byte by byte
+      const char *name_end = hit, *name;
+      int at = hit - ptr + JSON_BLOCK;
+      uint64_t before = quotes & (((uint64_t)1 << at) - 1);
+      if (before) {
+        at = json_top_(before);
+        name_end = ptr + (at - JSON_BLOCK);
+        before &= ~((uint64_t)1 << at);
+      } else {
+        while ((name_end>json) && is_space_(name_end[-1])) name_end--;
+        if ((name_end==json) || !is_doublequote_(*--name_end)) continue;
+      }
+      if (before) name = ptr + (json_top_(before) + 1 - JSON_BLOCK);
+      else {
+        for (name = name_end; name>json; name--) {
+          if (!is_doublequote_(name[-1])) continue;
+          const char *esc = name-1;
+          while ((esc>json) && is_escape_(esc[-1])) esc--;
+          if (!((name-1-esc) & 1)) break;
+        }
+        if (name==json) continue; // no opening quote
+      }
+      const char *p = name_end+1;
+      while ((p<hit) && is_space_(*p)) p++;
+      if (p<hit) continue; // something else between name and colon
+      size_t name_len = name_end - name;
+      int *link = &bucket[json_many_bucket_(name, name_len)];
+      while ((*link>=0) && ((key_len[*link]!=name_len) || 
+          (memcmp(keys[*link], name, name_len)!=0))) link = &chain[*link];
+      int k = *link;
+      if (k<0) continue;
+
+      const char *value = hit+1;
+      while ((value<end) && is_space_(*value)) value++;
+      spans[k].offset = value - json;
+      if ((value<end) && is_bracket_open_(*value)) { // keys inside it count too
+        spans[k].len = end - value; // unless it closes
+        spans[k].type = json_value_type(value, 1);
+        open[open_count] = k;
+        open_depth[open_count++] = depth;
+      } else scalar = k;
+      *link = chain[k]; // found: take it out of its bucket
+      pending--;
+    }
+    ptr += n;
   }
-  // copy value
-  int len = ptr_end - ptr_start;
-  if (len>size) len=size;
-  strncpy(dest, ptr_start, len);
+  if (scalar>=0) json_many_close(json, &spans[scalar], end);
+  int found_count = 0;
+  for (i=0; i<count; i++) {
+    if (same_as[i]>=0) spans[i] = spans[same_as[i]];
+    if (spans[i].type!=JSON_NONE) found_count++;
+  }
+  return found_count;
+}
+
+// copy a span of json to dest
+// copies at most size-1 bytes; dest is left alone when size<=0
+char *jsonSpanCopy(const char *json, const jsonSpan *span, char *dest, int size) {
+  size_t len = span->len;
+  if (size<=0) return dest;
+  if (len>=(size_t)size) len = size-1;
+  memcpy(dest, json + span->offset, len);
+  json_stat_(bytes_copied, len);
   dest[len] = '\0';
   return dest;
 }
 
-// escape/unescape a json string
-char *jsonEscape(const char *input, char *dest, int size) {
-  char *ptr_src = (char *)input;
-  char *ptr_dest = dest;
+char *jsonExtract(const char *json, const char *key_name, char *dest, int size) {
+  return jsonExtractN(json, json_strlen_(json), key_name, dest, size);
+}
 
-  if (!(*input)) {
-    *dest='\0'; return dest;
+// ---- path queries ----
+// a path is dotted ("a.b[3].c") or a JSON Pointer ("/a/b/3/c"). the
+// document is walked down once: at each level only the members of the
+// current object or list are looked at, values in between are skipped.
+
+// next segment of path; returns 1 with seg set, 0 at the end, -1 if malformed
+static int json_path_next(const char **path, int pointer, const char **seg, 
+    size_t *seg_len, int *is_index) {
+  const char *p = *path;
+  *is_index = 0;
+  if (!*p) return 0;
+  if (pointer) { // "/key", the key may be a list index
+    if (*p!='/') return -1;
+    *seg = ++p;
+    while (*p && (*p!='/')) p++;
+  } else if (*p=='[') { // "[3]"
+    *seg = ++p;
+    while (is_number_(*p)) p++;
+    if ((*p!=']') || (p==*seg)) return -1;
+    *seg_len = p - *seg;
+    *path = p+1;
+    *is_index = 1;
+    return 1;
+  } else { // "key" or ".key", never empty: only a pointer can name ""
+    if (*p=='.') p++;
+    *seg = p;
+    while (*p && (*p!='.') && (*p!='[')) p++;
+    if (p==*seg) return -1;
   }
+  *seg_len = p - *seg;
+  *path = p;
+  return 1;
+}
 
-  while ((*ptr_src) && ((ptr_dest-dest)<size-2)) {
-    if (is_doublequote_(*ptr_src)) {
-      *ptr_dest = '\\'; ptr_dest++;
+// key as written in JSON equals the segment (~0 and ~1 decoded for pointers)
+static int json_path_key_equal(const char *key, size_t key_len, const char *seg, 
+    size_t seg_len, int pointer) {
+  if (!pointer) return (key_len==seg_len) && (memcmp(key, seg, key_len)==0);
+  while (seg_len) {
+    char c = *seg++; seg_len--;
+    if ((c=='~') && seg_len && ((*seg=='0') || (*seg=='1'))) {
+      c = (*seg=='1') ? '/' : '~';
+      seg++; seg_len--;
     }
-    *ptr_dest = *ptr_src; ptr_dest++; ptr_src++; 
+    if (!key_len || (*key!=c)) return 0;
+    key++; key_len--;
   }
-  *ptr_dest = '\0';
+  return (key_len==0);
+}
+
+// value of a member in the object body at ptr, NULL if not there
+static const char *json_path_member(const char *ptr, const char *end, 
+    const char *seg, size_t seg_len, int pointer) {
+  while (1) {
+    while ((ptr<end) && (is_space_(*ptr) || (*ptr==','))) ptr++;
+    if ((ptr>=end) || !is_doublequote_(*ptr)) return NULL;
+    const char *key = ptr+1;
+    ptr = json_string_end(key, end);
+    size_t key_len = ptr - 1 - key;
+    while ((ptr<end) && is_space_(*ptr)) ptr++;
+    if ((ptr>=end) || (*ptr!=':')) return NULL;
+    ptr++;
+    while ((ptr<end) && is_space_(*ptr)) ptr++;
+    if (json_path_key_equal(key, key_len, seg, seg_len, pointer)) return ptr;
+    ptr = json_value_end(ptr, end);
+  }
+}
+
+// element of the list body at ptr, NULL if not there
+static const char *json_path_element(const char *ptr, const char *end, long index) {
+  while (1) {
+    while ((ptr<end) && is_space_(*ptr)) ptr++;
+    if ((ptr>=end) || (*ptr==']')) return NULL;
+    if (index--==0) return ptr;
+    ptr = json_value_end(ptr, end);
+    while ((ptr<end) && is_space_(*ptr)) ptr++;
+    if ((ptr>=end) || (*ptr!=',')) return NULL;
+    ptr++;
+  }
+}
+
+// locate the value at path; an empty path is the whole document
+// returns 1=found, 0=not found or malformed path
+int jsonQuerySpan(const char *json, size_t json_len, const char *path, jsonSpan *span) {
+  const char *ptr = json, *end = json + json_len, *seg;
+  int pointer = (*path=='/'), is_index, more;
+  size_t seg_len;
+
+  span->offset = 0; span->len = 0; span->type = JSON_NONE;
+  while ((ptr<end) && is_space_(*ptr)) ptr++;
+  while ((more = json_path_next(&path, pointer, &seg, &seg_len, &is_index))>0) {
+    if ((ptr<end) && (*ptr=='{') && !is_index) {
+      ptr = json_path_member(ptr+1, end, seg, seg_len, pointer);
+    } else if ((ptr<end) && (*ptr=='[') && (is_index || pointer)) {
+      long index = 0;
+      size_t i;
+      if ((seg_len==0) || (seg_len>9)) return 0;
+      for (i=0; i<seg_len; i++) {
+        if (!is_number_(seg[i])) return 0;
+        index = index*10 + (seg[i]-'0');
+      }
+      ptr = json_path_element(ptr+1, end, index);
+    } else {
+      return 0;
+    }
+    if (!ptr) return 0;
+  }
+  if (more<0) return 0;
+  const char *value_end = json_value_end(ptr, end);
+  if (value_end==ptr) return 0;
+  span->offset = ptr - json;
+  span->len = value_end - ptr;
+  span->type = json_value_type(ptr, span->len);
+  return 1;
+}
+
+// return the value at path
+char *jsonQuery(const char *json, const char *path, char *dest, int size) {
+  jsonSpan span;
+  if (!jsonQuerySpan(json, json_strlen_(json), path, &span)) {
+    if (size>0) *dest = '\0';
+    return NULL;
+  }
+  return jsonSpanCopy(json, &span, dest, size);
+}
+
+// escape/unescape a json string
+
+// escape for each byte: short form, 'u' for \u00XX, 0 to copy as is
+static const char json_escape_table[256] = {
+  'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u', // 0x00
+  json_row_('u'),                                                                 // 0x10
+  ['"']='"', ['\\']='\\'
+};
+
+// escape input into dest (NUL terminated, size incl. '\0'), clean runs are
+// copied in bulk. an escape that does not fit is left out whole.
+// returns length of the full escaped string (like snprintf: >= size means
+// it was cut), dest NULL only measures.
+int jsonEscapeTo(const char *input, size_t len, char *dest, int size) {
+  const char *ptr_src = input, *end = input + len;
+  const int classes = JSON_SCAN_QUOTE | JSON_SCAN_ESCAPE | JSON_SCAN_CONTROL;
+  size_t out_len = 0, written = 0, room = ((dest) && (size>0)) ? size-1 : 0;
+  int cut = !dest; // once something is left out, nothing after it is written
+
+  while (ptr_src<end) {
+    const char *run = json_scan(ptr_src, end, classes);
+    size_t count = run - ptr_src;
+    if (!cut) {
+      size_t n = (count <= room-written) ? count : room-written;
+      memcpy(dest+written, ptr_src, n);
+      json_stat_(bytes_copied, n);
+      written += n;
+      cut = (n<count);
+    }
+    out_len += count;
+    if (run>=end) break;
+
+    char esc = json_escape_table[(unsigned char)*run];
+    int esc_len = (esc=='u') ? 6 : 2;
+    if (!cut && (esc_len <= room-written)) {
+      char *ptr_dest = dest + written;
+      ptr_dest[0] = '\\'; ptr_dest[1] = esc;
+      if (esc=='u') {
+        static const char hex[] = "0123456789abcdef";
+        ptr_dest[2] = '0'; ptr_dest[3] = '0';
+        ptr_dest[4] = hex[(*run>>4) & 0xF]; ptr_dest[5] = hex[*run & 0xF];
+      }
+      written += esc_len;
+    } else cut = 1;
+    out_len += esc_len;
+    ptr_src = run+1;
+  }
+  if ((dest) && (size>0)) dest[written] = '\0';
+  return (int)out_len;
+}
+
+char *jsonEscapeN(const char *input, size_t len, char *dest, int size) {
+  jsonEscapeTo(input, len, dest, size);
   return dest;
 }
 
-char *jsonUnescape(const char *input, char *dest, int size) {
-  char *ptr_src = (char *)input;
-  char *ptr_dest = dest;
+char *jsonEscape(const char *input, char *dest, int size) {
+  return jsonEscapeN(input, json_strlen_(input), dest, size);
+}
 
-  if (!(*input)) {
-    *dest='\0'; return dest;
+// byte an escape \x stands for, 0 if there is no short form
+static const char json_unescape_table[256] = {
+  ['"'] = '"', ['\\'] = '\\', ['/'] = '/', ['b'] = '\b', 
+  ['f'] = '\f', ['n'] = '\n', ['r'] = '\r', ['t'] = '\t'
+};
+
+// value of 4 hex digits, -1 if not hex
+static int json_hex4(const char *ptr) {
+  int value = 0, i;
+  for (i=0; i<4; i++) {
+    int c = ptr[i];
+    if ((c>='0') && (c<='9')) c -= '0';
+    else if ((c>='a') && (c<='f')) c -= 'a'-10;
+    else if ((c>='A') && (c<='F')) c -= 'A'-10;
+    else return -1;
+    value = value*16 + c;
+  }
+  return value;
+}
+
+// UTF-8 encode code point, returns bytes used (1-4)
+static int json_utf8(unsigned code, char *out) {
+  if (code<0x80) { out[0] = code; return 1; }
+  if (code<0x800) {
+    out[0] = 0xC0 | (code>>6); out[1] = 0x80 | (code & 0x3F); return 2;
   }
-  char next;
-  while ((*ptr_src) && ((ptr_dest-dest)<size-1)) {
-    next=*(ptr_src+1);
-    if (is_escape_(*ptr_src) && is_doublequote_(next)) ptr_src++;
-    *ptr_dest = *ptr_src; ptr_dest++; ptr_src++; 
+  if (code<0x10000) {
+    out[0] = 0xE0 | (code>>12); out[1] = 0x80 | ((code>>6) & 0x3F);
+    out[2] = 0x80 | (code & 0x3F); return 3;
+  }
+  out[0] = 0xF0 | (code>>18); out[1] = 0x80 | ((code>>12) & 0x3F);
+  out[2] = 0x80 | ((code>>6) & 0x3F); out[3] = 0x80 | (code & 0x3F); return 4;
+}
+
+// decode escapes to UTF-8, runs without escapes are copied in bulk.
+// a decoded escape is never longer than its source, so dest may be input.
+// lone surrogates become U+FFFD, unknown escapes are copied as they are.
+// returns length of the decoded string, consumed (may be NULL) gets the
+// input used, less than len when dest ran out of room
+static size_t json_unescape(const char *input, size_t len, char *dest, int size,
+    size_t *consumed) {
+  const char *ptr_src = input, *end = input + len;
+  char *ptr_dest = dest, *dest_end = dest + size - 1;
+
+  while ((ptr_src<end) && (ptr_dest<dest_end)) {
+    const char *run = memchr(ptr_src, '\\', end-ptr_src);
+    if (!run) run = end;
+    size_t count = run - ptr_src;
+    if (count > (size_t)(dest_end-ptr_dest)) count = dest_end - ptr_dest;
+    if (ptr_dest!=ptr_src) memmove(ptr_dest, ptr_src, count);
+    json_stat_(bytes_copied, count);
+    ptr_dest += count; ptr_src += count;
+    if ((ptr_src>=end) || (ptr_dest>=dest_end)) break;
+
+    // ptr_src is at a backslash
+    char out[4];
+    int out_len = 0, used = 2;
+    unsigned char c = (ptr_src+1<end) ? ptr_src[1] : 0;
+    int code;
+    if (json_unescape_table[c]) {
+      out[0] = json_unescape_table[c]; out_len = 1;
+    } else if ((c=='u') && (end-ptr_src>=6) && ((code = json_hex4(ptr_src+2))>=0)) {
+      used = 6;
+      if ((code>=0xD800) && (code<=0xDBFF)) { // high surrogate, low must follow
+        int low = ((end-ptr_src>=12) && (ptr_src[6]=='\\') && (ptr_src[7]=='u')) ? 
+            json_hex4(ptr_src+8) : -1;
+        if ((low>=0xDC00) && (low<=0xDFFF)) {
+          code = 0x10000 + ((code-0xD800)<<10) + (low-0xDC00);
+          used = 12;
+        } else code = 0xFFFD;
+      } else if ((code>=0xDC00) && (code<=0xDFFF)) code = 0xFFFD;
+      out_len = json_utf8(code, out);
+    } else { // not an escape we know, keep the backslash
+      out[0] = '\\'; out_len = 1; used = 1;
+    }
+    if (out_len > dest_end-ptr_dest) break; // never split a character
+    memcpy(ptr_dest, out, out_len);
+    ptr_dest += out_len; ptr_src += used;
   }
   *ptr_dest = '\0';
+  if (consumed) *consumed = ptr_src - input;
+  return ptr_dest - dest;
+}
+
+char *jsonUnescapeN(const char *input, size_t len, char *dest, int size) {
+  json_unescape(input, len, dest, size, NULL);
   return dest;
 }
 
+char *jsonUnescape(const char *input, char *dest, int size) {
+  return jsonUnescapeN(input, json_strlen_(input), dest, size);
+}
+
 // create/parse a JSON quote-string
 char *jsonQuote(const char *input, char *dest, int size) {
-  char *ptr_dest = dest;
-  *ptr_dest = DOUBLEQUOTE; ptr_dest++;
-  jsonEscape(input, ptr_dest, size-2);
-  ptr_dest[strlen(ptr_dest)+1] = '\0';
-  ptr_dest[strlen(ptr_dest)+0] = DOUBLEQUOTE;
+  int len;
+  if (size<3) { if (size>0) *dest = '\0'; return dest; }
+  *dest = DOUBLEQUOTE;
+  len = jsonEscapeTo(input, json_strlen_(input), dest+1, size-2);
+  if (len >= size-2) len = json_strlen_(dest+1); // cut short
+  dest[len+1] = DOUBLEQUOTE;
+  dest[len+2] = '\0';
   return dest;
 }
 
 char *jsonUnquote(const char *input, char *dest, int size) {
   char *ptr_src = (char *)input;
-  if ((ptr_src[0]!=DOUBLEQUOTE) || (ptr_src[strlen(ptr_src)-1]!=DOUBLEQUOTE)) {
+  if ((ptr_src[0]!=DOUBLEQUOTE) || (ptr_src[json_strlen_(ptr_src)-1]!=DOUBLEQUOTE)) {
     // not in quotes
     strncpy(dest, input, size);
-    dest[strlen(input)] = '\0';
+    dest[json_strlen_(input)] = '\0';
     return dest;
   }
   jsonUnescape((input+1), dest, size);
-  dest[strlen(dest)-1] = '\0';
+  dest[json_strlen_(dest)-1] = '\0';
   return dest;
 }
 
-// key-value pair builder
-char *jsonAppendItem(const char *key, const char *value, char *dest, int size) {
-  // check min room
-  if (size < strlen(dest) + strlen(key) + strlen(value) + 5+2) {
-    return NULL;
+// ---- builder ----
+// tracks write position and room, so appending is O(1) amortized
+// instead of rescanning dest.
+
+void jsonBuildInit(jsonBuilder *builder, char *dest, int size) {
+  memset(builder, 0, sizeof(*builder));
+  builder->dest = dest;
+  builder->size = size;
+  if (size>0) *dest = '\0';
+  else builder->error = 1;
+}
+
+// append raw bytes, keeping room for the terminating '\0'
+static int json_build_put(jsonBuilder *builder, const char *data, int len) {
+  if (builder->error) return 0;
+  if (len >= builder->size - builder->len) {
+    json_stat_(overfills, 1);
+    builder->error = 1; return 0;
+  }
+  memcpy(builder->dest + builder->len, data, len);
+  json_stat_(bytes_copied, len);
+  builder->len += len;
+  builder->dest[builder->len] = '\0';
+  return 1;
+}
+
+// append a quoted, escaped string; on overflow dest is cut back to len
+static int json_build_quoted(jsonBuilder *builder, const char *value) {
+  int start = builder->len;
+  if (!json_build_put(builder, "\"", 1)) return 0;
+  int room = builder->size - builder->len - 1; // closing quote
+  int len = jsonEscapeTo(value, json_strlen_(value), builder->dest + builder->len, room);
+  if (len >= room) {
+    json_stat_(overfills, 1);
+    builder->len = start;
+    builder->dest[start] = '\0';
+    builder->error = 1; return 0;
   }
-  if (strlen(dest)==0) sprintf(dest, "{}");
+  builder->len += len;
+  return json_build_put(builder, "\"", 1);
+}
 
-  int rem = size-strlen(dest);
-  if (strlen(dest)>2) strcpy(dest + strlen(dest)-1, ",}\0");
+// separator and key before a value
+static int json_build_key(jsonBuilder *builder, const char *key) {
+  if (builder->error) return 0;
+  if (builder->len>0) {
+    char last = builder->dest[builder->len-1];
+    if ((last!='{') && (last!='[') && (last!=':')) {
+      if (!json_build_put(builder, ",", 1)) return 0;
+    }
+  }
+  if (key) {
+    if (!json_build_quoted(builder, key)) return 0;
+    return json_build_put(builder, ":", 1);
+  }
+  return 1;
+}
 
-  rem = size-strlen(dest);
-  jsonQuote(key, dest + strlen(dest) - 1, rem);
+static int json_build_open(jsonBuilder *builder, const char *key, int is_list) {
+  if (builder->depth>=JSON_BUILD_MAX_DEPTH) builder->error = 1;
+  if (!json_build_key(builder, key)) return 0;
+  if (!json_build_put(builder, (is_list) ? "[" : "{", 1)) return 0;
+  if (is_list) builder->lists |= ((uint64_t)1 << builder->depth);
+  else builder->lists &= ~((uint64_t)1 << builder->depth);
+  builder->depth++;
+  return 1;
+}
 
-  strcpy(dest + strlen(dest), ":\0");
+int jsonBuildObject(jsonBuilder *builder, const char *key) {
+  return json_build_open(builder, key, 0);
+}
 
-  rem = size-strlen(dest);
-  jsonQuote(value, dest + strlen(dest), rem);
+int jsonBuildArray(jsonBuilder *builder, const char *key) {
+  return json_build_open(builder, key, 1);
+}
 
-  strcpy(dest + strlen(dest), "}\0");
+// close innermost open struct or list
+int jsonBuildEnd(jsonBuilder *builder) {
+  if (builder->depth<=0) builder->error = 1;
+  if (builder->error) return 0;
+  builder->depth--;
+  return json_build_put(builder, 
+      (builder->lists & ((uint64_t)1 << builder->depth)) ? "]" : "}", 1);
+}
 
-  return dest;
+int jsonBuildString(jsonBuilder *builder, const char *key, const char *value) {
+  if (!json_build_key(builder, key)) return 0;
+  return json_build_quoted(builder, value);
 }
 
-// extract key-value JSON pair at position
-// returns 1=ok, 0=error
-int jsonGetKeyValue(const char *input, char *key, char *value, int item_size) {
-  // expected: "key":"value" -> key, value
-  // or "ke\"y":123 -> ke"y, 123
-  // skips rest of input
-  char *ptr_in = (char *)input;
-  char *ptr_out;
-  // expected: key is string
-  if (!is_doublequote_(*ptr_in)) { return 0; }
-  ptr_in++; 
-
-  char prev = *ptr_in;
-  ptr_out = key;
-  while (*ptr_in) {
-    if (is_doublequote_(*ptr_in) && (!is_escape_(prev))) break;
-    if (!is_escape_(*ptr_in) || is_escape_(prev)) {
-      *ptr_out=*ptr_in; ptr_out++;
-    } 
-    prev = *ptr_in; ptr_in++;
-    if ((ptr_out-key)>item_size-1) return 0; // ran out of room for key name
-  }
-  *ptr_out = '\0';
-  // have key, just fetch now
-  char *ret = jsonExtract(input, key, value, item_size);
-  return ((ret!=NULL)?1:0); 
+int jsonBuildInt(jsonBuilder *builder, const char *key, int64_t value) {
+  char buff[24], *ptr = buff + sizeof(buff);
+  uint64_t num = (value<0) ? -(uint64_t)value : (uint64_t)value;
+  do {
+    *--ptr = '0' + (num % 10); num /= 10;
+  } while (num);
+  if (value<0) *--ptr = '-';
+  if (!json_build_key(builder, key)) return 0;
+  return json_build_put(builder, ptr, buff + sizeof(buff) - ptr);
 }
 
-// returns offset to next key/value pair, or 0 for none remaining here.
-// returns 0 when time to add new_input
-// returns -1 on buffer overfill
-// set start_offset = last_offset to continue parsing
-// buffer should be >2x new_input size, >2x+5 max key+value size
-// skips named structs ("key":{"item":"value"}), and lists. ("key":["a","b"])
-#define JKVERR 
-int jsonStreamKeyValues(const char *new_input, char *buffer, int max_buffer, 
-    int start_offset, int *last_offset) {
-  //printf(">jskv(in l=%d, buff l=%d, so=%d)\n", 
-  //  (int)((new_input!=NULL)?strlen(new_input):0), (int)strlen(buffer), start_offset);
-  int new_start_offset = start_offset;
-  if (new_input) { // add to buffer 
-    //printf("adding to buffer\n");
-    if (strlen(new_input) + strlen(buffer)<max_buffer-1) { // just append
-      //printf("just append\n");
-      int max_len = max_buffer -1 - strlen(buffer);
-      strncpy(buffer+strlen(buffer), new_input, max_len);  
-    } else { // shift by new buffer item
-      if (strlen(new_input)+max_buffer-start_offset>max_buffer-1) { 
-        //printf("err: no room\n"); 
-        return -1; 
-      }
-      //printf("offset\n");
-      int offset=1+strlen(new_input);
-      //printf("delta=%i\n", offset);
-      char *ptr = buffer;
-      while (*(ptr+offset)) { *ptr = *(ptr+offset); ptr++; }
-      strncpy(ptr, new_input, max_buffer-(ptr-buffer));
-      new_start_offset = start_offset - offset;      
-      if (new_start_offset<0) {
-        //printf("not enough buffer to parse\n"); 
-        return -1;
-      }
-    }
-  }
-  //printf("buff='%s'\n", buffer);
-  //printf("buff len=%d, start=%d (%c)\n", (int)strlen(buffer), new_start_offset, *(buffer+new_start_offset));
-  // read until quote
-  char *ptr = buffer + new_start_offset;
-  while ((!is_doublequote_(*ptr)) && *ptr) ptr++;
-  if (!*ptr) { 
-    //printf("no quotes found\n");
-    *last_offset = ptr-buffer; return 0; } // no quotes found
-  char *key_start = ptr; // ptr is at start of key
-
-  char prev=*ptr; ptr++;
-  while (*ptr && !(is_doublequote_(*ptr) || is_escape_(prev))) {
-    prev = *ptr; ptr++;
-  }
-  if (!*ptr) { 
-    //printf("end of string in key\n");
-    *last_offset = new_start_offset; return 0; }
-  // ptr is at end of quote for key
-  //printf("got key\n");
-  // expect ":"
-  ptr++; 
-  if (!*ptr) {
-    //printf("end of string before : after key\n");
-    *last_offset = new_start_offset; return 0; }
-  if (*ptr!=':') { // if no :, try from here
-    //printf("no : found after key (got %c)\n", *ptr);
-    return jsonStreamKeyValues(NULL, buffer, max_buffer, (ptr-buffer), last_offset);
+// value of a finite double in format, with '.' whatever LC_NUMERIC says
+static int json_double_format(char *buff, size_t size, const char *format, double value) {
+  int len = snprintf(buff, size, format, value), i = 0, sep;
+  while ((i<len) && (is_number_(buff[i]) || (buff[i]=='-'))) i++;
+  if ((i<len) && (buff[i]!='e') && (buff[i]!='E')) { // the decimal point, maybe several bytes
+    sep = i;
+    while ((i<len) && !is_number_(buff[i])) i++;
+    buff[sep] = '.';
+    memmove(buff+sep+1, buff+i, len-i+1);
+    len -= i-sep-1;
   }
-  ptr++;
-  // await: number, quote, comma, {, }, [, ]
-  while (*ptr && is_space_(*ptr)) ptr++;
-  if (!*ptr) { 
-    //printf("end of string before value\n");
-    *last_offset = new_start_offset; return 0; }
-  if (is_bracket_open_(*ptr) || is_bracket_close_(*ptr) || (*ptr==',')) {
-    //printf("got bracket or comma (%c), restart\n", *ptr);
-    return jsonStreamKeyValues(NULL, buffer, max_buffer, (ptr-buffer), last_offset);
-  }
-  if ((*ptr=='-') || is_number_(*ptr)) {
-    //printf("got number\n");
-    ptr++;
-    while ((*ptr) && (is_number_(*ptr) || (*ptr=='.'))) ptr++;
-    if (!*ptr) { 
-      //printf("end of string before end of value\n");
-      *last_offset = new_start_offset; return 0; }
-    // looks ok, let's push it
-    //printf("got value complete\n");
-    *last_offset = (ptr-buffer);
-    return (key_start-buffer);
-  } else if (*ptr=='"') {
-    //printf("got string\n");
-    ptr++;prev=*ptr;
+  return len;
+}
+
+// shortest of %.15g / %.17g that reads back the same
+static int json_double_text(char *buff, size_t size, double value) {
+  double back;
+  int len = json_double_format(buff, size, "%.15g", value);
+  if (!jsonParseDouble(buff, len, &back) || (back!=value)) len = json_double_format(buff, size, "%.17g", value);
+  return len;
+}
+
+// nan/inf become null
+int jsonBuildDouble(jsonBuilder *builder, const char *key, double value) {
+  char buff[32];
+  if ((value!=value) || (value-value!=0)) return jsonBuildNull(builder, key);
+  int len = json_double_text(buff, sizeof(buff), value);
+  if (!json_build_key(builder, key)) return 0;
+  return json_build_put(builder, buff, len);
+}
+
+int jsonBuildBool(jsonBuilder *builder, const char *key, int value) {
+  if (!json_build_key(builder, key)) return 0;
+  return (value) ? json_build_put(builder, "true", 4) : json_build_put(builder, "false", 5);
+}
+
+int jsonBuildNull(jsonBuilder *builder, const char *key) {
+  if (!json_build_key(builder, key)) return 0;
+  return json_build_put(builder, "null", 4);
+}
+
+// append already formatted JSON as value
+int jsonBuildRaw(jsonBuilder *builder, const char *key, const char *json) {
+  if (!json_build_key(builder, key)) return 0;
+  return json_build_put(builder, json, json_strlen_(json));
+}
+
+// key-value pair builder
+// appends to the struct in dest; dest is measured once per call,
+// use jsonBuilder to append many items
+char *jsonAppendItem(const char *key, const char *value, char *dest, int size) {
+  jsonBuilder builder;
+  int len = json_strlen_(dest);
+  // check min room
+  if (size < len + json_strlen_(key) + json_strlen_(value) + 5+2) {
+    return NULL;
+  }
+  if (len==0) {
+    strcpy(dest, "{}"); len = 2;
+  }
+  // reopen the struct: drop closing bracket
+  memset(&builder, 0, sizeof(builder));
+  builder.dest = dest; builder.size = size;
+  builder.len = len-1; builder.depth = 1;
+  if (!jsonBuildString(&builder, key, value) || !jsonBuildEnd(&builder)) {
+    strcpy(dest+len-1, "}");
+    return NULL;
+  }
+  return dest;
+}
+
+// extract key-value JSON pair at position
+// returns 1=ok, 0=error
+int jsonGetKeyValue(const char *input, char *key, char *value, int item_size) {
+  // expected: "key":"value" -> key, value
+  // or "ke\"y":123 -> ke"y, 123
+  // skips rest of input
+  jsonCursor cursor;
+  jsonSpan key_span, value_span;
+  if (!is_doublequote_(*input) || (item_size<=0)) { return 0; }
+  json_cursor_body(&cursor, input, 0, json_strlen_(input), 1);
+  if (!jsonObjectNext(&cursor, &key_span, &value_span)) return 0;
+  json_cursor_close(&cursor, &value_span);
+  if (value_span.len && (value_span.type==JSON_NONE)) return 0; // not true/false/null
+  size_t used;
+  json_unescape(input + key_span.offset, key_span.len, key, item_size, &used);
+  if (used<key_span.len) return 0; // ran out of room for key name
+  jsonSpanCopy(input, &value_span, value, item_size);
+  return 1;
+}
+
+// returns offset to next key/value pair, or 0 for none remaining here.
+// returns 0 when time to add new_input
+// returns -1 on buffer overfill
+// set start_offset = last_offset to continue parsing
+// buffer should be >2x new_input size, >2x+5 max key+value size
+// skips named structs ("key":{"item":"value"}), and lists. ("key":["a","b"])
+#define JKVERR 
+int jsonStreamKeyValues(const char *new_input, char *buffer, int max_buffer, 
+    int start_offset, int *last_offset) {
+  int new_start_offset = start_offset;
+  int buffer_len = json_strlen_(buffer);
+  if (new_input) { // add to buffer 
+    int input_len = json_strlen_(new_input);
+    if (input_len + buffer_len<max_buffer-1) { // just append
+      memcpy(buffer+buffer_len, new_input, input_len+1);
+      json_stat_(bytes_copied, input_len);
+      buffer_len += input_len;
+    } else { // shift by new buffer item
+      if (input_len+max_buffer-start_offset>max_buffer-1) { 
+        json_stat_(overfills, 1);
+        return -1; // err: no room
+      }
+      int offset=1+input_len;
+      memmove(buffer, buffer+offset, buffer_len-offset);
+      json_stat_(buffer_shifts, 1);
+      json_stat_(shift_bytes, buffer_len-offset);
+      buffer_len -= offset;
+      memcpy(buffer+buffer_len, new_input, input_len+1);
+      json_stat_(bytes_copied, input_len);
+      buffer_len += input_len;
+      new_start_offset = start_offset - offset;      
+      if (new_start_offset<0) {
+        json_stat_(overfills, 1);
+        return -1; // not enough buffer to parse
+      }
+    }
+  }
+  const char *end = buffer + buffer_len;
+
+  while (1) { // restart here on broken json
+    // read until quote
+    char *ptr = (char *)json_scan(buffer + new_start_offset, end, JSON_SCAN_QUOTE);
+    if (!*ptr) { // no quotes found
+      *last_offset = ptr-buffer; return 0; }
+    char *key_start = ptr; // ptr is at start of key
+
+    char prev=*ptr; ptr++;
     while (*ptr && !(is_doublequote_(*ptr) || is_escape_(prev))) {
       prev = *ptr; ptr++;
     }
-    if (!*ptr) { 
-      //printf("end of string before end of value\n");
+    if (!*ptr) { // end of string in key
+      *last_offset = new_start_offset; return 0; }
+    // ptr is at end of quote for key, expect ":"
+    ptr++; 
+    if (!*ptr) { // end of string before : after key
+      *last_offset = new_start_offset; return 0; }
+    if (*ptr!=':') { // if no :, try from here
+      json_stat_(stream_restarts, 1);
+      new_start_offset = ptr-buffer; continue;
+    }
+    ptr++;
+    // await: number, quote, comma, {, }, [, ]
+    while (*ptr && is_space_(*ptr)) ptr++;
+    if (!*ptr) { // end of string before value
       *last_offset = new_start_offset; return 0; }
-    // looks ok
-    //printf("got value complete\n");
+    if (is_bracket_open_(*ptr) || is_bracket_close_(*ptr) || (*ptr==',')) {
+      json_stat_(stream_restarts, 1);
+      new_start_offset = ptr-buffer; continue; // got bracket or comma, restart
+    }
+    if ((*ptr=='-') || is_number_(*ptr)) { // got number
+      ptr++;
+      while ((*ptr) && (is_number_(*ptr) || (*ptr=='.'))) ptr++;
+      if (!*ptr) { // end of string before end of value
+        *last_offset = new_start_offset; return 0; }
+      // looks ok, let's push it
+      *last_offset = (ptr-buffer);
+      return (key_start-buffer);
+    } else if (*ptr=='"') { // got string
+      ptr++;prev=*ptr;
+      while (*ptr && !(is_doublequote_(*ptr) || is_escape_(prev))) {
+        prev = *ptr; ptr++;
+      }
+      if (!*ptr) { // end of string before end of value
+        *last_offset = new_start_offset; return 0; }
+      // looks ok
+      ptr++;
+      *last_offset = (ptr-buffer);
+      return (key_start-buffer);
+    }
+    // broken json, just continue from here
+    json_stat_(stream_restarts, 1);
+    new_start_offset = ptr-buffer;
+  }
+}
+
+
+// ---- token tape ----
+// one pass over the input records offset, length, type and depth of every
+// token into caller storage. lookups then hop over tokens instead of bytes.
+
+#define is_token_end_(x) ( is_space_(x) || ((x)==',') || ((x)==':') || \
+    is_bracket_open_(x) || is_bracket_close_(x) || is_doublequote_(x) )
+
+// build token tape over json[0..len), returns count or -1 on overfill.
+// offsets are int, so json over INT_MAX bytes is refused with -1 too.
+// while a struct/list is open its "next" holds the index of its parent
+static int json_tokenize(const char *json, size_t json_len, jsonToken *tokens, int max_tokens) {
+  int count = 0, depth = 0, open = -1, pos = 0;
+  if (json_len>INT_MAX) return -1;
+  int len = (int)json_len;
+
+  while (pos<len) {
+    char ch = json[pos];
+    if (is_space_(ch) || (ch==',') || (ch==':')) { pos++; continue; }
+    if (is_bracket_close_(ch)) {
+      if (open>=0) { // stray closing brackets are ignored
+        int parent = tokens[open].next;
+        tokens[open].len = pos + 1 - tokens[open].offset;
+        tokens[open].next = count;
+        open = parent; depth--;
+      }
+      pos++; continue;
+    }
+    if (count>=max_tokens) { json_stat_(overfills, 1); return -1; }
+    jsonToken *tok = &tokens[count];
+    tok->offset = pos; tok->depth = depth; tok->is_key = 0;
+    tok->next = count+1;
+
+    if (is_bracket_open_(ch)) { // struct or list, closed later
+      tok->type = (ch=='{') ? JSON_OBJECT : JSON_ARRAY;
+      tok->next = open; open = count; depth++;
+      pos++;
+    } else if (is_doublequote_(ch)) { // string, maybe a key
+      const char *ptr = json+pos+1, *end = json+len;
+      while (1) { // jump between quotes and escapes
+        ptr = json_scan(ptr, end, JSON_SCAN_QUOTE | JSON_SCAN_ESCAPE);
+        if ((ptr>=end) || is_doublequote_(*ptr)) break;
+        ptr += 2;
+      }
+      pos = (ptr<end) ? (ptr-json)+1 : len; // include closing quote
+      tok->type = JSON_STRING;
+      int p = pos;
+      while ((p<len) && is_space_(json[p])) p++;
+      tok->is_key = ((p<len) && (json[p]==':'));
+    } else { // number, literal or something unknown
+      while ((pos<len) && !is_token_end_(json[pos])) pos++;
+      tok->type = json_word_type(json+tok->offset, pos-tok->offset);
+    }
+    if (tok->type!=JSON_OBJECT && tok->type!=JSON_ARRAY) tok->len = pos - tok->offset;
+    count++;
+  }
+  while (open>=0) { // unterminated structs/lists run to the end
+    int parent = tokens[open].next;
+    tokens[open].len = len - tokens[open].offset;
+    tokens[open].next = count;
+    open = parent;
+  }
+  return count;
+}
+
+int jsonTokenizeN(const char *json, size_t len, jsonToken *tokens, int max_tokens) {
+  return json_tokenize(json, len, tokens, max_tokens);
+}
+
+int jsonTokenize(const char *json, jsonToken *tokens, int max_tokens) {
+  return json_tokenize(json, json_strlen_(json), tokens, max_tokens);
+}
+
+// find key token; parent=-1 searches all keys in order like jsonExtract,
+// otherwise only direct members of struct parent
+static int json_token_key(const char *json, const jsonToken *tokens, int count, 
+    int parent, const char *key_name) {
+  int klen = json_strlen_(key_name);
+  int i = 0, end = count, step_over = 0;
+
+  if (parent>=0) {
+    if ((parent>=count) || (tokens[parent].type!=JSON_OBJECT)) return -1;
+    i = parent+1; end = tokens[parent].next; step_over = 1;
+  }
+  while (i<end) {
+    const jsonToken *tok = &tokens[i];
+    if (tok->is_key && (tok->len==klen+2) && 
+        (memcmp(json+tok->offset+1, key_name, klen)==0)) return i;
+    i = (step_over) ? tok->next : i+1;
+  }
+  return -1;
+}
+
+// value token following key token, -1 if missing
+static int json_token_value(const jsonToken *tokens, int count, int key) {
+  int i = key+1;
+  if ((i>=count) || tokens[i].is_key || (tokens[i].depth!=tokens[key].depth)) return -1;
+  return i;
+}
+
+// returns index of the value token for key_name, or -1
+int jsonTokenFind(const char *json, const jsonToken *tokens, int count, 
+    int parent, const char *key_name) {
+  int key = json_token_key(json, tokens, count, parent, key_name);
+  if (key<0) return -1;
+  return json_token_value(tokens, count, key);
+}
+
+// returns index of the n-th value in parent (-1 = top level), or -1
+// keys of structs are not counted
+int jsonTokenChild(const jsonToken *tokens, int count, int parent, int index) {
+  int i = 0, end = count;
+  if (parent>=0) {
+    if (parent>=count) return -1;
+    i = parent+1; end = tokens[parent].next;
+  }
+  while (i<end) {
+    if (!tokens[i].is_key) {
+      if (index==0) return i;
+      index--;
+    }
+    i = tokens[i].next;
+  }
+  return -1;
+}
+
+// copy token text to dest
+char *jsonTokenCopy(const char *json, const jsonToken *token, char *dest, int size) {
+  int len = token->len;
+  if (size<=0) return dest;
+  if (len>=size) len = size-1;
+  memcpy(dest, json+token->offset, len);
+  json_stat_(bytes_copied, len);
+  dest[len] = '\0';
+  return dest;
+}
+
+// same as jsonExtract, using a token tape of json
+char *jsonTokenExtract(const char *json, const jsonToken *tokens, int count, 
+    const char *name, char *dest, int size) {
+  int key = json_token_key(json, tokens, count, -1, name);
+  if (key<0) { // not found at all
+    *dest = '\0'; return NULL;
+  }
+  int value = json_token_value(tokens, count, key);
+  if (value<0) { // key without value
+    *dest = '\0'; return dest;
+  }
+  if (tokens[value].type==JSON_NONE) { // undefined type, give up
+    *dest = '\0'; return NULL;
+  }
+  return jsonTokenCopy(json, &tokens[value], dest, size);
+}
+
+// same as jsonIndexList, using a token tape of json
+char *jsonTokenIndexList(const char *json, const jsonToken *tokens, int count, 
+    int index, char *dest, int size) {
+  int i = jsonTokenChild(tokens, count, -1, index);
+  if (i<0) {
+    *dest = '\0'; return NULL;
+  }
+  return jsonTokenCopy(json, &tokens[i], dest, size);
+}
+
+// same as jsonGetKeyValue for the key at token key_token
+// returns 1=ok, 0=error
+int jsonTokenGetKeyValue(const char *json, const jsonToken *tokens, int count, 
+    int key_token, char *key, char *value, int item_size) {
+  if ((key_token<0) || (key_token>=count) || !tokens[key_token].is_key || (item_size<=0)) return 0;
+  size_t key_len = (tokens[key_token].len>=2) ? tokens[key_token].len - 2 : 0, used;
+  json_unescape(json + tokens[key_token].offset + 1, key_len, key, item_size, &used);
+  if (used<key_len) return 0; // ran out of room for key name
+
+  int i = json_token_value(tokens, count, key_token);
+  if (i<0) {
+    *value = '\0'; return 1;
+  }
+  jsonTokenCopy(json, &tokens[i], value, item_size);
+  return 1;
+}
+
+
+// ---- resumable key/value stream ----
+// fed bytes go into a ring buffer and are parsed exactly once; the parser
+// state survives between chunks, so tokens split over many chunks are
+// never rescanned and accepted data is never moved.
+
+enum {
+  JSON_STREAM_SEEK = 0,   // looking for a key
+  JSON_STREAM_KEY,
+  JSON_STREAM_KEY_ESC,
+  JSON_STREAM_COLON,
+  JSON_STREAM_VALUE,
+  JSON_STREAM_STRING,
+  JSON_STREAM_STRING_ESC,
+  JSON_STREAM_NUMBER,
+  JSON_STREAM_LITERAL,
+  JSON_STREAM_SKIP,       // rest of a string that did not fit the ring buffer
+  JSON_STREAM_SKIP_ESC
+};
+
+#define is_number_char_(x) ( is_number_(x) || ((x)=='.') || ((x)=='-') || \
+    ((x)=='+') || ((x)=='e') || ((x)=='E') )
+#define is_lower_(x) ( ((x)>='a') && ((x)<='z') )
+
+void jsonStreamInit(jsonStream *stream, char *buffer, size_t size) {
+  memset(stream, 0, sizeof(*stream));
+  stream->buffer = buffer;
+  stream->size = size;
+}
+
+// append up to len bytes, returns number of bytes taken
+// call jsonStreamNext until it returns 0 to make room for more
+size_t jsonStreamFeed(jsonStream *stream, const char *data, size_t len) {
+  size_t room = stream->size - (stream->end - stream->start);
+  if (len>room) len = room;
+  size_t at = stream->end % stream->size;
+  size_t first = stream->size - at;
+  if (first>len) first = len;
+  memcpy(stream->buffer+at, data, first);
+  memcpy(stream->buffer, data+first, len-first);
+  stream->end += len;
+  return len;
+}
+
+// copy ring bytes [from, to) to dest
+static void json_ring_copy(const jsonStream *stream, size_t from, size_t to, char *dest) {
+  size_t len = to - from;
+  size_t at = from % stream->size;
+  size_t first = stream->size - at;
+  if (first>len) first = len;
+  memcpy(dest, stream->buffer+at, first);
+  memcpy(dest+first, stream->buffer, len-first);
+  json_stat_(bytes_copied, len);
+}
+
+// hand out finished pair, value ends before value_end
+static int json_stream_emit(jsonStream *stream, size_t value_end, 
+    char *key, char *value, int item_size) {
+  size_t key_len = stream->key_end - stream->key_start - 2;
+  size_t value_len = value_end - stream->value_start;
+  stream->state = JSON_STREAM_SEEK;
+  stream->start = stream->pos;
+  if ((key_len>=item_size) || (value_len>=item_size)) {
+    json_stat_(overfills, 1); return -1;
+  }
+  json_ring_copy(stream, stream->key_start+1, stream->key_end-1, key);
+  key[key_len] = '\0';
+  jsonUnescape(key, key, item_size);
+  json_ring_copy(stream, stream->value_start, value_end, value);
+  value[value_len] = '\0';
+  return 1;
+}
+
+// parse on to the next key/value pair
+// returns 1 with key (unescaped) and value (as in JSON) filled in,
+// 0 when more input is needed, -1 when a pair did not fit the ring buffer
+// or item_size (the pair is skipped). nested structs/lists are not
+// reported, their members are.
+int jsonStreamNext(jsonStream *stream, char *key, char *value, int item_size) {
+  while (stream->pos < stream->end) {
+    size_t base = stream->pos;
+    size_t at = base % stream->size;
+    size_t len = stream->end - base;
+    if (len > stream->size - at) len = stream->size - at;
+    const char *seg = stream->buffer + at;
+    const char *ptr = seg, *end = seg + len;
+
+    while (ptr<end) {
+      char ch = *ptr;
+      switch (stream->state) {
+      case JSON_STREAM_SEEK:
+        ptr = json_scan(ptr, end, JSON_SCAN_QUOTE);
+        if (ptr<end) {
+          stream->key_start = stream->start = base + (ptr-seg);
+          stream->state = JSON_STREAM_KEY; ptr++;
+        }
+        break;
+      case JSON_STREAM_KEY:
+      case JSON_STREAM_STRING:
+        ptr = json_scan(ptr, end, JSON_SCAN_QUOTE | JSON_SCAN_ESCAPE);
+        if (ptr>=end) break;
+        if (is_escape_(*ptr)) {
+          stream->state = (stream->state==JSON_STREAM_KEY) ? 
+              JSON_STREAM_KEY_ESC : JSON_STREAM_STRING_ESC;
+          ptr++; break;
+        }
+        ptr++;
+        if (stream->state==JSON_STREAM_KEY) {
+          stream->key_end = base + (ptr-seg);
+          stream->state = JSON_STREAM_COLON; break;
+        }
+        stream->pos = base + (ptr-seg);
+        return json_stream_emit(stream, stream->pos, key, value, item_size);
+      case JSON_STREAM_KEY_ESC:
+        stream->state = JSON_STREAM_KEY; ptr++; break;
+      case JSON_STREAM_STRING_ESC:
+        stream->state = JSON_STREAM_STRING; ptr++; break;
+      case JSON_STREAM_SKIP:
+        ptr = json_scan(ptr, end, JSON_SCAN_QUOTE | JSON_SCAN_ESCAPE);
+        if (ptr>=end) break;
+        stream->state = (is_escape_(*ptr)) ? JSON_STREAM_SKIP_ESC : JSON_STREAM_SEEK;
+        ptr++; break;
+      case JSON_STREAM_SKIP_ESC:
+        stream->state = JSON_STREAM_SKIP; ptr++; break;
+      case JSON_STREAM_COLON:
+        if (is_space_(ch)) { ptr++; break; }
+        if (ch==':') { stream->state = JSON_STREAM_VALUE; ptr++; break; }
+        stream->state = JSON_STREAM_SEEK; // not a key, look again from here
+        break;
+      case JSON_STREAM_VALUE:
+        if (is_space_(ch)) { ptr++; break; }
+        stream->value_start = base + (ptr-seg);
+        if (is_doublequote_(ch)) stream->state = JSON_STREAM_STRING;
+        else if (is_number_(ch) || (ch=='-')) stream->state = JSON_STREAM_NUMBER;
+        else if ((ch=='t') || (ch=='f') || (ch=='n')) stream->state = JSON_STREAM_LITERAL;
+        else { // struct, list or broken json: look again from here
+          stream->state = JSON_STREAM_SEEK; break;
+        }
+        ptr++; break;
+      case JSON_STREAM_NUMBER:
+      case JSON_STREAM_LITERAL:
+        if (stream->state==JSON_STREAM_NUMBER) {
+          while ((ptr<end) && is_number_char_(*ptr)) ptr++;
+        } else {
+          while ((ptr<end) && is_lower_(*ptr)) ptr++;
+        }
+        if (ptr>=end) break; // value may go on in next chunk
+        stream->pos = base + (ptr-seg);
+        if (stream->state==JSON_STREAM_LITERAL) {
+          char word[6];
+          size_t word_len = stream->pos - stream->value_start;
+          if (word_len>5) word_len = 5;
+          json_ring_copy(stream, stream->value_start, stream->value_start+word_len, word);
+          if (json_word_type(word, stream->pos - stream->value_start)==JSON_NONE) {
+            stream->state = JSON_STREAM_SEEK; break;
+          }
+        }
+        return json_stream_emit(stream, stream->pos, key, value, item_size);
+      }
+    }
+    stream->pos = base + len;
+  }
+
+  switch (stream->state) {
+  case JSON_STREAM_SEEK: case JSON_STREAM_SKIP: case JSON_STREAM_SKIP_ESC:
+    stream->start = stream->pos; // nothing pending, release all
+    return 0;
+  }
+  if (stream->end - stream->start >= stream->size) { // pair fills buffer
+    // drop the pair; a string in it is skipped to its end with the escape
+    // state it had, so its text is not parsed as json
+    switch (stream->state) {
+    case JSON_STREAM_KEY: case JSON_STREAM_STRING: stream->state = JSON_STREAM_SKIP; break;
+    case JSON_STREAM_KEY_ESC: case JSON_STREAM_STRING_ESC: stream->state = JSON_STREAM_SKIP_ESC; break;
+    default: stream->state = JSON_STREAM_SEEK;
+    }
+    stream->start = stream->pos;
+    json_stat_(overfills, 1);
+    return -1;
+  }
+  return 0;
+}
+
+
+// ---- number decoding ----
+// numbers are decoded straight from the input bytes: integers exactly,
+// doubles with the Clinger fast path when mantissa and power of ten are
+// both exact, else Eisel-Lemire on a 128-bit power of five. the rare
+// ambiguous case falls back to strtod.
+
+#define JSON_POW5_MIN (-342)
+#define JSON_POW5_MAX 308
+
+// 128-bit truncated 5^q for q in [-342,308], high word first
+static const uint64_t json_pow5[2*(JSON_POW5_MAX-JSON_POW5_MIN+1)] = {
+  0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL, // 5^-342
+  0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL, // 5^-341
+  0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL, // 5^-340
+  0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL, // 5^-339
+  0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL, // 5^-338
+  0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL, // 5^-337
+  0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL, // 5^-336
+  0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL, // 5^-335
+  0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL, // 5^-334
+  0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL, // 5^-333
+  0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL, // 5^-332
+  0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL, // 5^-331
+  0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL, // 5^-330
+  0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL, // 5^-329
+  0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL, // 5^-328
+  0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL, // 5^-327
+  0x84a57695fe98746dULL, 0x014bb630f7604b57ULL, // 5^-326
+  0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL, // 5^-325
+  0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL, // 5^-324
+  0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL, // 5^-323
+  0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL, // 5^-322
+  0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL, // 5^-321
+  0xfd00b897478238d0ULL, 0x8920b098955522b4ULL, // 5^-320
+  0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL, // 5^-319
+  0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL, // 5^-318
+  0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL, // 5^-317
+  0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL, // 5^-316
+  0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL, // 5^-315
+  0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL, // 5^-314
+  0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL, // 5^-313
+  0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL, // 5^-312
+  0xeba09271e88d976bULL, 0xf7864a44c633682eULL, // 5^-311
+  0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL, // 5^-310
+  0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL, // 5^-309
+  0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL, // 5^-308
+  0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL, // 5^-307
+  0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL, // 5^-306
+  0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL, // 5^-305
+  0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL, // 5^-304
+  0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL, // 5^-303
+  0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL, // 5^-302
+  0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL, // 5^-301
+  0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL, // 5^-300
+  0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL, // 5^-299
+  0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL, // 5^-298
+  0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL, // 5^-297
+  0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL, // 5^-296
+  0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL, // 5^-295
+  0xa37fce126597973cULL, 0xe50ff107bab528a0ULL, // 5^-294
+  0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL, // 5^-293
+  0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL, // 5^-292
+  0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL, // 5^-291
+  0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL, // 5^-290
+  0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL, // 5^-289
+  0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL, // 5^-288
+  0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL, // 5^-287
+  0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL, // 5^-286
+  0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL, // 5^-285
+  0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL, // 5^-284
+  0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL, // 5^-283
+  0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL, // 5^-282
+  0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL, // 5^-281
+  0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL, // 5^-280
+  0x91376c36d99995beULL, 0x23100809b9c21fa1ULL, // 5^-279
+  0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL, // 5^-278
+  0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL, // 5^-277
+  0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL, // 5^-276
+  0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL, // 5^-275
+  0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL, // 5^-274
+  0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL, // 5^-273
+  0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL, // 5^-272
+  0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL, // 5^-271
+  0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL, // 5^-270
+  0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL, // 5^-269
+  0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL, // 5^-268
+  0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL, // 5^-267
+  0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL, // 5^-266
+  0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL, // 5^-265
+  0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL, // 5^-264
+  0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL, // 5^-263
+  0xc987434744ac874eULL, 0xa327ffb266b56220ULL, // 5^-262
+  0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL, // 5^-261
+  0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL, // 5^-260
+  0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL, // 5^-259
+  0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL, // 5^-258
+  0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL, // 5^-257
+  0xc0314325637a1939ULL, 0xfa911155fefb5308ULL, // 5^-256
+  0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL, // 5^-255
+  0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL, // 5^-254
+  0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL, // 5^-253
+  0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL, // 5^-252
+  0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL, // 5^-251
+  0xb749faed14125d36ULL, 0xcef980ec671f667bULL, // 5^-250
+  0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL, // 5^-249
+  0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL, // 5^-248
+  0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL, // 5^-247
+  0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL, // 5^-246
+  0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL, // 5^-245
+  0xaecc49914078536dULL, 0x58fae9f773886e18ULL, // 5^-244
+  0xda7f5bf590966848ULL, 0xaf39a475506a899eULL, // 5^-243
+  0x888f99797a5e012dULL, 0x6d8406c952429603ULL, // 5^-242
+  0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL, // 5^-241
+  0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL, // 5^-240
+  0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL, // 5^-239
+  0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL, // 5^-238
+  0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL, // 5^-237
+  0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL, // 5^-236
+  0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL, // 5^-235
+  0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL, // 5^-234
+  0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL, // 5^-233
+  0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL, // 5^-232
+  0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL, // 5^-231
+  0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL, // 5^-230
+  0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL, // 5^-229
+  0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL, // 5^-228
+  0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL, // 5^-227
+  0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL, // 5^-226
+  0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL, // 5^-225
+  0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL, // 5^-224
+  0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL, // 5^-223
+  0xb913179899f68584ULL, 0x28e2557b59846e3fULL, // 5^-222
+  0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL, // 5^-221
+  0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL, // 5^-220
+  0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL, // 5^-219
+  0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL, // 5^-218
+  0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL, // 5^-217
+  0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL, // 5^-216
+  0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL, // 5^-215
+  0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL, // 5^-214
+  0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL, // 5^-213
+  0xd77485cb25823ac7ULL, 0x7d633293366b828bULL, // 5^-212
+  0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL, // 5^-211
+  0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL, // 5^-210
+  0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL, // 5^-209
+  0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL, // 5^-208
+  0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL, // 5^-207
+  0xcd795be870516656ULL, 0x67902e276c921f8bULL, // 5^-206
+  0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL, // 5^-205
+  0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL, // 5^-204
+  0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL, // 5^-203
+  0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL, // 5^-202
+  0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL, // 5^-201
+  0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL, // 5^-200
+  0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL, // 5^-199
+  0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL, // 5^-198
+  0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL, // 5^-197
+  0xef340a98172aace4ULL, 0x86fb897116c87c34ULL, // 5^-196
+  0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL, // 5^-195
+  0xbae0a846d2195712ULL, 0x8974836059cca109ULL, // 5^-194
+  0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL, // 5^-193
+  0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL, // 5^-192
+  0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL, // 5^-191
+  0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL, // 5^-190
+  0x8e938662882af53eULL, 0x547eb47b7282ee9cULL, // 5^-189
+  0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL, // 5^-188
+  0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL, // 5^-187
+  0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL, // 5^-186
+  0xae0b158b4738705eULL, 0x9624ab50b148d445ULL, // 5^-185
+  0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL, // 5^-184
+  0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL, // 5^-183
+  0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL, // 5^-182
+  0xd47487cc8470652bULL, 0x7647c3200069671fULL, // 5^-181
+  0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL, // 5^-180
+  0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL, // 5^-179
+  0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL, // 5^-178
+  0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL, // 5^-177
+  0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL, // 5^-176
+  0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL, // 5^-175
+  0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL, // 5^-174
+  0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL, // 5^-173
+  0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL, // 5^-172
+  0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL, // 5^-171
+  0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL, // 5^-170
+  0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL, // 5^-169
+  0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL, // 5^-168
+  0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL, // 5^-167
+  0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL, // 5^-166
+  0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL, // 5^-165
+  0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL, // 5^-164
+  0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL, // 5^-163
+  0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL, // 5^-162
+  0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL, // 5^-161
+  0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL, // 5^-160
+  0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL, // 5^-159
+  0x8c974f7383725573ULL, 0x1e414218c73a13fbULL, // 5^-158
+  0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL, // 5^-157
+  0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL, // 5^-156
+  0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL, // 5^-155
+  0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL, // 5^-154
+  0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL, // 5^-153
+  0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL, // 5^-152
+  0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL, // 5^-151
+  0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL, // 5^-150
+  0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL, // 5^-149
+  0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL, // 5^-148
+  0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL, // 5^-147
+  0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL, // 5^-146
+  0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL, // 5^-145
+  0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL, // 5^-144
+  0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL, // 5^-143
+  0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL, // 5^-142
+  0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL, // 5^-141
+  0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL, // 5^-140
+  0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL, // 5^-139
+  0xbe89523386091465ULL, 0xf6bbb397f1135823ULL, // 5^-138
+  0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL, // 5^-137
+  0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL, // 5^-136
+  0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL, // 5^-135
+  0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL, // 5^-134
+  0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL, // 5^-133
+  0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL, // 5^-132
+  0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL, // 5^-131
+  0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL, // 5^-130
+  0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL, // 5^-129
+  0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL, // 5^-128
+  0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL, // 5^-127
+  0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL, // 5^-126
+  0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL, // 5^-125
+  0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL, // 5^-124
+  0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL, // 5^-123
+  0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL, // 5^-122
+  0x843610cb4bf160cbULL, 0xcedf722a585139baULL, // 5^-121
+  0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL, // 5^-120
+  0xce947a3da6a9273eULL, 0x733d226229feea32ULL, // 5^-119
+  0x811ccc668829b887ULL, 0x0806357d5a3f525fULL, // 5^-118
+  0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL, // 5^-117
+  0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL, // 5^-116
+  0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL, // 5^-115
+  0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL, // 5^-114
+  0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL, // 5^-113
+  0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL, // 5^-112
+  0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL, // 5^-111
+  0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL, // 5^-110
+  0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL, // 5^-109
+  0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL, // 5^-108
+  0xbbe226efb628afeaULL, 0x890489f70a55368bULL, // 5^-107
+  0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL, // 5^-106
+  0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL, // 5^-105
+  0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL, // 5^-104
+  0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL, // 5^-103
+  0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL, // 5^-102
+  0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL, // 5^-101
+  0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL, // 5^-100
+  0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL, // 5^-99
+  0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL, // 5^-98
+  0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL, // 5^-97
+  0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL, // 5^-96
+  0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL, // 5^-95
+  0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL, // 5^-94
+  0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL, // 5^-93
+  0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL, // 5^-92
+  0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL, // 5^-91
+  0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL, // 5^-90
+  0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL, // 5^-89
+  0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL, // 5^-88
+  0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL, // 5^-87
+  0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL, // 5^-86
+  0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL, // 5^-85
+  0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL, // 5^-84
+  0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL, // 5^-83
+  0xc24452da229b021bULL, 0xfbe85badce996168ULL, // 5^-82
+  0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL, // 5^-81
+  0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL, // 5^-80
+  0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL, // 5^-79
+  0xed246723473e3813ULL, 0x290123e9aab23b68ULL, // 5^-78
+  0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL, // 5^-77
+  0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL, // 5^-76
+  0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL, // 5^-75
+  0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL, // 5^-74
+  0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL, // 5^-73
+  0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL, // 5^-72
+  0x8d590723948a535fULL, 0x579c487e5a38ad0eULL, // 5^-71
+  0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL, // 5^-70
+  0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL, // 5^-69
+  0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL, // 5^-68
+  0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL, // 5^-67
+  0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL, // 5^-66
+  0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL, // 5^-65
+  0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, // 5^-64
+  0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL, // 5^-63
+  0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, // 5^-62
+  0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL, // 5^-61
+  0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, // 5^-60
+  0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL, // 5^-59
+  0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, // 5^-58
+  0xc8de047564d20a8bULL, 0xf245825a5a445275ULL, // 5^-57
+  0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, // 5^-56
+  0x9ced737bb6c4183dULL, 0x55464dd69685606bULL, // 5^-55
+  0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, // 5^-54
+  0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL, // 5^-53
+  0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, // 5^-52
+  0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL, // 5^-51
+  0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, // 5^-50
+  0x95a8637627989aadULL, 0xdde7001379a44aa8ULL, // 5^-49
+  0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, // 5^-48
+  0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL, // 5^-47
+  0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, // 5^-46
+  0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL, // 5^-45
+  0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, // 5^-44
+  0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL, // 5^-43
+  0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, // 5^-42
+  0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL, // 5^-41
+  0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, // 5^-40
+  0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL, // 5^-39
+  0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, // 5^-38
+  0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL, // 5^-37
+  0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, // 5^-36
+  0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL, // 5^-35
+  0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, // 5^-34
+  0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL, // 5^-33
+  0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, // 5^-32
+  0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL, // 5^-31
+  0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, // 5^-30
+  0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL, // 5^-29
+  0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, // 5^-28
+  0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL, // 5^-27
+  0xc612062576589ddaULL, 0x95364afe032a819eULL, // 5^-26
+  0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL, // 5^-25
+  0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, // 5^-24
+  0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL, // 5^-23
+  0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, // 5^-22
+  0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL, // 5^-21
+  0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, // 5^-20
+  0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL, // 5^-19
+  0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, // 5^-18
+  0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL, // 5^-17
+  0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, // 5^-16
+  0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL, // 5^-15
+  0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, // 5^-14
+  0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL, // 5^-13
+  0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, // 5^-12
+  0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL, // 5^-11
+  0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, // 5^-10
+  0x89705f4136b4a597ULL, 0x31680a88f8953031ULL, // 5^-9
+  0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, // 5^-8
+  0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL, // 5^-7
+  0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, // 5^-6
+  0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL, // 5^-5
+  0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, // 5^-4
+  0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL, // 5^-3
+  0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, // 5^-2
+  0xccccccccccccccccULL, 0xcccccccccccccccdULL, // 5^-1
+  0x8000000000000000ULL, 0x0000000000000000ULL, // 5^0
+  0xa000000000000000ULL, 0x0000000000000000ULL, // 5^1
+  0xc800000000000000ULL, 0x0000000000000000ULL, // 5^2
+  0xfa00000000000000ULL, 0x0000000000000000ULL, // 5^3
+  0x9c40000000000000ULL, 0x0000000000000000ULL, // 5^4
+  0xc350000000000000ULL, 0x0000000000000000ULL, // 5^5
+  0xf424000000000000ULL, 0x0000000000000000ULL, // 5^6
+  0x9896800000000000ULL, 0x0000000000000000ULL, // 5^7
+  0xbebc200000000000ULL, 0x0000000000000000ULL, // 5^8
+  0xee6b280000000000ULL, 0x0000000000000000ULL, // 5^9
+  0x9502f90000000000ULL, 0x0000000000000000ULL, // 5^10
+  0xba43b74000000000ULL, 0x0000000000000000ULL, // 5^11
+  0xe8d4a51000000000ULL, 0x0000000000000000ULL, // 5^12
+  0x9184e72a00000000ULL, 0x0000000000000000ULL, // 5^13
+  0xb5e620f480000000ULL, 0x0000000000000000ULL, // 5^14
+  0xe35fa931a0000000ULL, 0x0000000000000000ULL, // 5^15
+  0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, // 5^16
+  0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL, // 5^17
+  0xde0b6b3a76400000ULL, 0x0000000000000000ULL, // 5^18
+  0x8ac7230489e80000ULL, 0x0000000000000000ULL, // 5^19
+  0xad78ebc5ac620000ULL, 0x0000000000000000ULL, // 5^20
+  0xd8d726b7177a8000ULL, 0x0000000000000000ULL, // 5^21
+  0x878678326eac9000ULL, 0x0000000000000000ULL, // 5^22
+  0xa968163f0a57b400ULL, 0x0000000000000000ULL, // 5^23
+  0xd3c21bcecceda100ULL, 0x0000000000000000ULL, // 5^24
+  0x84595161401484a0ULL, 0x0000000000000000ULL, // 5^25
+  0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, // 5^26
+  0xcecb8f27f4200f3aULL, 0x0000000000000000ULL, // 5^27
+  0x813f3978f8940984ULL, 0x4000000000000000ULL, // 5^28
+  0xa18f07d736b90be5ULL, 0x5000000000000000ULL, // 5^29
+  0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, // 5^30
+  0xfc6f7c4045812296ULL, 0x4d00000000000000ULL, // 5^31
+  0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, // 5^32
+  0xc5371912364ce305ULL, 0x6c28000000000000ULL, // 5^33
+  0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, // 5^34
+  0x9a130b963a6c115cULL, 0x3c7f400000000000ULL, // 5^35
+  0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, // 5^36
+  0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL, // 5^37
+  0x96769950b50d88f4ULL, 0x1314448000000000ULL, // 5^38
+  0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL, // 5^39
+  0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, // 5^40
+  0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL, // 5^41
+  0xb7abc627050305adULL, 0xf14a3d9e40000000ULL, // 5^42
+  0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL, // 5^43
+  0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL, // 5^44
+  0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL, // 5^45
+  0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL, // 5^46
+  0x8c213d9da502de45ULL, 0x4526f422cc340000ULL, // 5^47
+  0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, // 5^48
+  0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL, // 5^49
+  0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL, // 5^50
+  0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL, // 5^51
+  0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL, // 5^52
+  0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL, // 5^53
+  0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL, // 5^54
+  0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL, // 5^55
+  0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, // 5^56
+  0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL, // 5^57
+  0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL, // 5^58
+  0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL, // 5^59
+  0x9f4f2726179a2245ULL, 0x01d762422c946590ULL, // 5^60
+  0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL, // 5^61
+  0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL, // 5^62
+  0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL, // 5^63
+  0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL, // 5^64
+  0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL, // 5^65
+  0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL, // 5^66
+  0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL, // 5^67
+  0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL, // 5^68
+  0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL, // 5^69
+  0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL, // 5^70
+  0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL, // 5^71
+  0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL, // 5^72
+  0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL, // 5^73
+  0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL, // 5^74
+  0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL, // 5^75
+  0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL, // 5^76
+  0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL, // 5^77
+  0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL, // 5^78
+  0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL, // 5^79
+  0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL, // 5^80
+  0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL, // 5^81
+  0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL, // 5^82
+  0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL, // 5^83
+  0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL, // 5^84
+  0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL, // 5^85
+  0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL, // 5^86
+  0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL, // 5^87
+  0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL, // 5^88
+  0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL, // 5^89
+  0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL, // 5^90
+  0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL, // 5^91
+  0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL, // 5^92
+  0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL, // 5^93
+  0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL, // 5^94
+  0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL, // 5^95
+  0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL, // 5^96
+  0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL, // 5^97
+  0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL, // 5^98
+  0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL, // 5^99
+  0x924d692ca61be758ULL, 0x593c2626705f9c56ULL, // 5^100
+  0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL, // 5^101
+  0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL, // 5^102
+  0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL, // 5^103
+  0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL, // 5^104
+  0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL, // 5^105
+  0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL, // 5^106
+  0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL, // 5^107
+  0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL, // 5^108
+  0x884134fe908658b2ULL, 0x3109058d147fdcddULL, // 5^109
+  0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL, // 5^110
+  0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL, // 5^111
+  0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL, // 5^112
+  0xa6539930bf6bff45ULL, 0x84db8346b786151cULL, // 5^113
+  0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL, // 5^114
+  0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL, // 5^115
+  0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL, // 5^116
+  0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL, // 5^117
+  0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL, // 5^118
+  0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL, // 5^119
+  0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL, // 5^120
+  0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL, // 5^121
+  0x9ae757596946075fULL, 0x3375788de9b06958ULL, // 5^122
+  0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL, // 5^123
+  0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL, // 5^124
+  0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL, // 5^125
+  0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL, // 5^126
+  0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL, // 5^127
+  0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL, // 5^128
+  0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL, // 5^129
+  0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL, // 5^130
+  0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL, // 5^131
+  0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL, // 5^132
+  0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL, // 5^133
+  0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL, // 5^134
+  0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL, // 5^135
+  0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL, // 5^136
+  0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL, // 5^137
+  0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL, // 5^138
+  0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL, // 5^139
+  0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL, // 5^140
+  0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL, // 5^141
+  0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL, // 5^142
+  0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL, // 5^143
+  0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL, // 5^144
+  0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL, // 5^145
+  0x802221226be55a64ULL, 0xc2494954da2c9789ULL, // 5^146
+  0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL, // 5^147
+  0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL, // 5^148
+  0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL, // 5^149
+  0x9c69a97284b578d7ULL, 0xff2a760414536efbULL, // 5^150
+  0xc38413cf25e2d70dULL, 0xfef5138519684abaULL, // 5^151
+  0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL, // 5^152
+  0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL, // 5^153
+  0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL, // 5^154
+  0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL, // 5^155
+  0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL, // 5^156
+  0xba756174393d88dfULL, 0x94f971119aeef9e4ULL, // 5^157
+  0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL, // 5^158
+  0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL, // 5^159
+  0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL, // 5^160
+  0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL, // 5^161
+  0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL, // 5^162
+  0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL, // 5^163
+  0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL, // 5^164
+  0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL, // 5^165
+  0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL, // 5^166
+  0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL, // 5^167
+  0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL, // 5^168
+  0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL, // 5^169
+  0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL, // 5^170
+  0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL, // 5^171
+  0xa59bc234db398c25ULL, 0x43fab9837e699095ULL, // 5^172
+  0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL, // 5^173
+  0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL, // 5^174
+  0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL, // 5^175
+  0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL, // 5^176
+  0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL, // 5^177
+  0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL, // 5^178
+  0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL, // 5^179
+  0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL, // 5^180
+  0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL, // 5^181
+  0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL, // 5^182
+  0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL, // 5^183
+  0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL, // 5^184
+  0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL, // 5^185
+  0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL, // 5^186
+  0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL, // 5^187
+  0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL, // 5^188
+  0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL, // 5^189
+  0x8fa475791a569d10ULL, 0xf96e017d694487bcULL, // 5^190
+  0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL, // 5^191
+  0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL, // 5^192
+  0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL, // 5^193
+  0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL, // 5^194
+  0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL, // 5^195
+  0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL, // 5^196
+  0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL, // 5^197
+  0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL, // 5^198
+  0x85c7056562757456ULL, 0xf6872d5667844e49ULL, // 5^199
+  0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL, // 5^200
+  0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL, // 5^201
+  0x82a45b450226b39cULL, 0xecc0024661173473ULL, // 5^202
+  0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL, // 5^203
+  0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL, // 5^204
+  0xff290242c83396ceULL, 0x7e67047175a15271ULL, // 5^205
+  0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL, // 5^206
+  0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL, // 5^207
+  0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL, // 5^208
+  0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL, // 5^209
+  0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL, // 5^210
+  0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL, // 5^211
+  0x98165af37b2153deULL, 0xc3727a337a8b704aULL, // 5^212
+  0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL, // 5^213
+  0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL, // 5^214
+  0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL, // 5^215
+  0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL, // 5^216
+  0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL, // 5^217
+  0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL, // 5^218
+  0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL, // 5^219
+  0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL, // 5^220
+  0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL, // 5^221
+  0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL, // 5^222
+  0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL, // 5^223
+  0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL, // 5^224
+  0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL, // 5^225
+  0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL, // 5^226
+  0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL, // 5^227
+  0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL, // 5^228
+  0xd31045a8341ca07cULL, 0x1ede48111209a050ULL, // 5^229
+  0x83ea2b892091e44dULL, 0x934aed0aab460432ULL, // 5^230
+  0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL, // 5^231
+  0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL, // 5^232
+  0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL, // 5^233
+  0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL, // 5^234
+  0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL, // 5^235
+  0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL, // 5^236
+  0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL, // 5^237
+  0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL, // 5^238
+  0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL, // 5^239
+  0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL, // 5^240
+  0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL, // 5^241
+  0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL, // 5^242
+  0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL, // 5^243
+  0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL, // 5^244
+  0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL, // 5^245
+  0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL, // 5^246
+  0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL, // 5^247
+  0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL, // 5^248
+  0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL, // 5^249
+  0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL, // 5^250
+  0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL, // 5^251
+  0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL, // 5^252
+  0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL, // 5^253
+  0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL, // 5^254
+  0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL, // 5^255
+  0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL, // 5^256
+  0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL, // 5^257
+  0x8533285c936b35deULL, 0xd53a88958f87275fULL, // 5^258
+  0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL, // 5^259
+  0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL, // 5^260
+  0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL, // 5^261
+  0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL, // 5^262
+  0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL, // 5^263
+  0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL, // 5^264
+  0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL, // 5^265
+  0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL, // 5^266
+  0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL, // 5^267
+  0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL, // 5^268
+  0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL, // 5^269
+  0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL, // 5^270
+  0x976e41088617ca01ULL, 0xd5be0503e085d813ULL, // 5^271
+  0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL, // 5^272
+  0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL, // 5^273
+  0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL, // 5^274
+  0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL, // 5^275
+  0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL, // 5^276
+  0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL, // 5^277
+  0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL, // 5^278
+  0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL, // 5^279
+  0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL, // 5^280
+  0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL, // 5^281
+  0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL, // 5^282
+  0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL, // 5^283
+  0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL, // 5^284
+  0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL, // 5^285
+  0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL, // 5^286
+  0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL, // 5^287
+  0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL, // 5^288
+  0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL, // 5^289
+  0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL, // 5^290
+  0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL, // 5^291
+  0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL, // 5^292
+  0xa0555e361951c366ULL, 0xd7e105bcc332621fULL, // 5^293
+  0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL, // 5^294
+  0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL, // 5^295
+  0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL, // 5^296
+  0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL, // 5^297
+  0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL, // 5^298
+  0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL, // 5^299
+  0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL, // 5^300
+  0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL, // 5^301
+  0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL, // 5^302
+  0xbaa718e68396cffdULL, 0xd30560258f54e6baULL, // 5^303
+  0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL, // 5^304
+  0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL, // 5^305
+  0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL, // 5^306
+  0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL, // 5^307
+  0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL, // 5^308
+};
+
+static const double json_pow10[23] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// full 64x64 -> 128 bit product
+static void json_mul128(uint64_t a, uint64_t b, uint64_t *high, uint64_t *low) {
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 r = (unsigned __int128)a * b;
+  *high = (uint64_t)(r >> 64);
+  *low = (uint64_t)r;
+#else
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32, b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi;
+  uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+  *high = a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+  *low = (cross << 32) | (uint32_t)lo_lo;
+#endif
+}
+
+static int json_clz64(uint64_t x) {
+#ifdef __GNUC__
+  return __builtin_clzll(x);
+#else
+  int n = 0;
+  while (!(x & 0x8000000000000000ULL)) { x <<= 1; n++; }
+  return n;
+#endif
+}
+
+// w * 10^q as IEEE bits (sign excluded) with Eisel-Lemire;
+// returns 1=ok, 0=cannot decide, w must not be 0
+static int json_eisel_lemire(uint64_t w, int q, uint64_t *bits) {
+  uint64_t high, low, second_high, second_low, mantissa;
+  int lz, upper, power2;
+  const uint64_t *pow5;
+
+  if (q<JSON_POW5_MIN) { *bits = 0; return 1; }
+  if (q>JSON_POW5_MAX) { *bits = 0x7FFULL << 52; return 1; }
+  lz = json_clz64(w);
+  w <<= lz;
+  pow5 = json_pow5 + 2*(q-JSON_POW5_MIN);
+  json_mul128(w, pow5[0], &high, &low);
+  if ((high & 0x1FF)==0x1FF) { // lower bits may carry, refine
+    json_mul128(w, pow5[1], &second_high, &second_low);
+    low += second_high;
+    if (second_high>low) high++;
+    // still all ones: the next bits could carry, fine only where 5^q is exact
+    if ((low==0xFFFFFFFFFFFFFFFFULL) && ((q<-27) || (q>55))) return 0;
+  }
+  upper = (int)(high >> 63);
+  mantissa = high >> (upper + 9);
+  power2 = (((152170 + 65536) * q) >> 16) + 63 + upper - lz + 1023;
+
+  if (power2<=0) { // subnormal
+    if (-power2+1>=64) { *bits = 0; return 1; }
+    mantissa >>= -power2 + 1;
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    power2 = (mantissa < (1ULL << 52)) ? 0 : 1;
+    *bits = (mantissa & ((1ULL << 52) - 1)) | ((uint64_t)power2 << 52);
+    return 1;
+  }
+  // exactly halfway between two doubles: round to even
+  if ((low<=1) && (q>=-4) && (q<=23) && ((mantissa & 3)==1)) {
+    if ((mantissa << (upper + 9))==high) mantissa &= ~(uint64_t)1;
+  }
+  mantissa += (mantissa & 1);
+  mantissa >>= 1;
+  if (mantissa>=(2ULL << 52)) { mantissa = 1ULL << 52; power2++; }
+  mantissa &= ~(1ULL << 52);
+  if (power2>=0x7FF) { *bits = 0x7FFULL << 52; return 1; }
+  *bits = mantissa | ((uint64_t)power2 << 52);
+  return 1;
+}
+
+// parse an integer number; returns 1=ok, 0=not an integer or out of range
+int jsonParseInt64(const char *ptr, size_t len, int64_t *out) {
+  const char *end = ptr + len;
+  uint64_t num = 0;
+  int neg = 0;
+  if ((ptr<end) && (*ptr=='-')) { neg = 1; ptr++; }
+  if ((ptr>=end) || (end-ptr>20)) return 0;
+  if ((*ptr=='0') && (end-ptr>1)) return 0; // no leading zeros
+  while (ptr<end) {
+    unsigned digit = (unsigned char)*ptr - '0';
+    if (digit>9) return 0;
+    if (num > (UINT64_MAX - digit) / 10) return 0;
+    num = num*10 + digit; ptr++;
+  }
+  if (num > (uint64_t)INT64_MAX + neg) return 0;
+  *out = (neg) ? (int64_t)(0-num) : (int64_t)num;
+  return 1;
+}
+
+// parse a number as double, correctly rounded; returns 1=ok, 0=not a number
+int jsonParseDouble(const char *ptr, size_t len, double *out) {
+  const char *start = ptr, *end = ptr + len, *digits;
+  uint64_t w = 0, bits, bits_up;
+  int neg = 0, count = 0, truncated = 0, exp = 0;
+  double value;
+
+  if ((ptr<end) && (*ptr=='-')) { neg = 1; ptr++; }
+  digits = ptr;
+  if ((ptr>=end) || !is_number_(*ptr)) return 0;
+  if ((*ptr=='0') && (ptr+1<end) && is_number_(ptr[1])) return 0;
+  // up to 19 significant digits fit the mantissa, the rest only shift it
+  for (; (ptr<end) && is_number_(*ptr); ptr++) {
+    if (count<19) { w = w*10 + (*ptr-'0'); count += (w!=0); }
+    else { exp++; truncated |= (*ptr!='0'); }
+  }
+  if ((ptr<end) && (*ptr=='.')) {
+    const char *frac = ++ptr;
+    for (; (ptr<end) && is_number_(*ptr); ptr++) {
+      if (count<19) { w = w*10 + (*ptr-'0'); count += (w!=0); exp--; }
+      else truncated |= (*ptr!='0');
+    }
+    if (ptr==frac) return 0;
+  }
+  if ((ptr<end) && ((*ptr=='e') || (*ptr=='E'))) {
+    int exp_neg = 0, e = 0;
+    ptr++;
+    if ((ptr<end) && ((*ptr=='+') || (*ptr=='-'))) exp_neg = (*ptr++=='-');
+    if ((ptr>=end) || !is_number_(*ptr)) return 0;
+    for (; (ptr<end) && is_number_(*ptr); ptr++) {
+      if (e<100000) e = e*10 + (*ptr-'0');
+    }
+    exp += (exp_neg) ? -e : e;
+  }
+  if ((ptr!=end) || (ptr==digits)) return 0;
+
+  if (w==0) { *out = (neg) ? -0.0 : 0.0; return 1; }
+  if (!truncated && (w<=(1ULL << 53)) && (exp>=-22) && (exp<=22)) { // exact
+    value = (double)w;
+    value = (exp<0) ? value / json_pow10[-exp] : value * json_pow10[exp];
+    *out = (neg) ? -value : value;
+    return 1;
+  }
+  // a truncated mantissa lies between w and w+1, both must round the same
+  if (json_eisel_lemire(w, exp, &bits) && 
+      (!truncated || (json_eisel_lemire(w+1, exp, &bits_up) && (bits==bits_up)))) {
+    bits |= (uint64_t)neg << 63;
+    memcpy(out, &bits, sizeof(*out));
+    return 1;
+  }
+  // undecided, let the C library round, with its decimal point for '.'
+  const char *point = localeconv()->decimal_point, *dot = memchr(start, '.', len);
+  size_t point_len = (dot) ? strlen(point) : 1;
+  char buff[128], *copy = buff;
+  if ((len+point_len>=sizeof(buff)) && !(copy = malloc(len+point_len))) return 0;
+  if (dot) {
+    memcpy(copy, start, dot-start);
+    memcpy(copy + (dot-start), point, point_len);
+    memcpy(copy + (dot-start) + point_len, dot+1, end-dot-1);
+    copy[len-1+point_len] = '\0';
+  } else {
+    memcpy(copy, start, len);
+    copy[len] = '\0';
+  }
+  *out = strtod(copy, NULL);
+  if (copy!=buff) free(copy);
+  return 1;
+}
+
+// integer value of a number, fractions cut off; returns 1=ok, 0=not a number
+static int json_number_int64(const char *ptr, size_t len, int64_t *out) {
+  double value;
+  if (jsonParseInt64(ptr, len, out)) return 1;
+  if (!jsonParseDouble(ptr, len, &value)) return 0;
+  if ((value < -9223372036854775808.0) || (value >= 9223372036854775808.0)) return 0;
+  *out = (int64_t)value;
+  return 1;
+}
+
+// decode the value of a span
+// returns its type, JSON_NONE for an empty span or a broken number
+jsonType jsonDecodeValue(const char *json, const jsonSpan *span, jsonValue *value) {
+  const char *ptr = json + span->offset;
+  memset(value, 0, sizeof(*value));
+  value->span = *span;
+  value->type = span->type;
+  switch (span->type) {
+  case JSON_NUMBER:
+    if (jsonParseInt64(ptr, span->len, &value->int_value)) {
+      value->is_int = 1;
+      value->double_value = (double)value->int_value;
+    } else if (!jsonParseDouble(ptr, span->len, &value->double_value)) {
+      value->type = JSON_NONE;
+    }
+    break;
+  case JSON_TRUE:
+    value->bool_value = 1;
+    break;
+  default:
+    break;
+  }
+  return value->type;
+}
+
+// decode the value of key_name, returns its type, JSON_NONE if not found
+jsonType jsonExtractValue(const char *json, size_t json_len, const char *key_name, 
+    jsonValue *value) {
+  jsonSpan span;
+  if (!jsonExtractSpan(json, json_len, key_name, &span)) {
+    memset(value, 0, sizeof(*value));
+    return JSON_NONE;
+  }
+  return jsonDecodeValue(json, &span, value);
+}
+
+// integer value of key_name, fractions cut off
+// returns 1=ok, 0=not found or not a number in range
+int jsonExtractInt64(const char *json, const char *key_name, int64_t *out) {
+  jsonSpan span;
+  if (!jsonExtractSpan(json, json_strlen_(json), key_name, &span) || 
+      (span.type!=JSON_NUMBER)) return 0;
+  return json_number_int64(json + span.offset, span.len, out);
+}
+
+// double value of key_name, returns 1=ok, 0=not found or not a number
+int jsonExtractDouble(const char *json, const char *key_name, double *out) {
+  jsonValue value;
+  if (jsonExtractValue(json, json_strlen_(json), key_name, &value)!=JSON_NUMBER) return 0;
+  *out = value.double_value;
+  return 1;
+}
+
+// boolean value of key_name, returns 1=ok, 0=not found or not true/false
+int jsonExtractBool(const char *json, const char *key_name, int *out) {
+  jsonValue value;
+  jsonType type = jsonExtractValue(json, json_strlen_(json), key_name, &value);
+  if ((type!=JSON_TRUE) && (type!=JSON_FALSE)) return 0;
+  *out = value.bool_value;
+  return 1;
+}
+
+
+// ---- schema binding ----
+// a compiled schema maps each key to its struct field with a perfect hash,
+// so a flat struct decodes in one pass: hash the key, check one name,
+// convert the value straight from the input into the field.
+
+static uint32_t json_schema_hash(const char *key, size_t len, uint32_t seed) {
+  uint32_t hash = seed ^ ((uint32_t)len * 0x9e3779b1);
+  size_t i;
+  for (i=0; i<len; i++) hash = (hash ^ (unsigned char)key[i]) * 0x01000193;
+  return hash ^ (hash >> 15);
+}
+
+// find a seed that puts every field name in its own slot
+// returns 1=ok, 0=too many fields or duplicate names
+int jsonSchemaCompile(jsonSchema *schema, const jsonField *fields, int count) {
+  uint32_t seed, size = 8;
+  int i, j;
+
+  memset(schema, 0, sizeof(*schema));
+  if ((count<0) || (count>JSON_SCHEMA_MAX_FIELDS)) return 0;
+  while ((size < 4*(uint32_t)count) && (size < JSON_SCHEMA_SLOTS)) size *= 2;
+  schema->fields = fields;
+  schema->count = count;
+  schema->mask = size-1;
+  for (i=0; i<count; i++) {
+    size_t len = json_strlen_(fields[i].name);
+    if (len>255) return 0;
+    schema->name_len[i] = len;
+    for (j=0; j<i; j++) { // no seed can part equal names
+      if ((schema->name_len[j]==len) && (memcmp(fields[j].name, fields[i].name, len)==0)) return 0;
+    }
+  }
+  for (seed=1; seed<1000000; seed++) {
+    memset(schema->slots, 0, sizeof(schema->slots));
+    for (i=0; i<count; i++) {
+      uint32_t slot = json_schema_hash(fields[i].name, schema->name_len[i], seed) & schema->mask;
+      if (schema->slots[slot]) break;
+      schema->slots[slot] = i+1;
+    }
+    if (i==count) {
+      schema->seed = seed;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// convert value into the field, returns 1 if set
+static int json_field_set(const jsonField *field, const char *value, size_t len, void *out) {
+  char *dest = (char *)out + field->offset;
+  jsonType type = json_value_type(value, len);
+  int64_t num;
+  double real;
+
+  switch (field->type) {
+  case JSON_FIELD_INT:
+    if ((type!=JSON_NUMBER) || !json_number_int64(value, len, &num)) return 0;
+    if ((num<-2147483647-1) || (num>2147483647)) return 0;
+    *(int *)dest = (int)num;
+    return 1;
+  case JSON_FIELD_INT64:
+    if ((type!=JSON_NUMBER) || !json_number_int64(value, len, &num)) return 0;
+    *(int64_t *)dest = num;
+    return 1;
+  case JSON_FIELD_DOUBLE:
+    if ((type!=JSON_NUMBER) || !jsonParseDouble(value, len, &real)) return 0;
+    *(double *)dest = real;
+    return 1;
+  case JSON_FIELD_BOOL:
+    if ((type!=JSON_TRUE) && (type!=JSON_FALSE)) return 0;
+    *(int *)dest = (type==JSON_TRUE);
+    return 1;
+  case JSON_FIELD_STRING:
+    if ((type!=JSON_STRING) || (len<2) || (field->size<1)) return 0;
+    jsonUnescapeN(value+1, len-2, dest, field->size);
+    return 1;
+  }
+  return 0;
+}
+
+// decode a flat JSON struct into out; unknown keys, nested values, nulls
+// and values of the wrong type leave the struct untouched.
+// returns number of fields set, -1 on broken JSON
+int jsonSchemaDecode(const jsonSchema *schema, const char *json, size_t len, void *out) {
+  const char *ptr = json, *end = json + len;
+  int set = 0;
+
+  while ((ptr<end) && is_space_(*ptr)) ptr++;
+  if ((ptr>=end) || (*ptr!='{')) return -1;
+  ptr++;
+  while (1) {
+    while ((ptr<end) && (is_space_(*ptr) || (*ptr==','))) ptr++;
+    if (ptr>=end) return -1;
+    if (*ptr=='}') break;
+    if (!is_doublequote_(*ptr)) return -1;
+    const char *key = ptr+1;
+    ptr = json_string_end(key, end);
+    if (ptr>=end) return -1;
+    size_t key_len = ptr - 1 - key;
+    while ((ptr<end) && is_space_(*ptr)) ptr++;
+    if ((ptr>=end) || (*ptr!=':')) return -1;
+    ptr++;
+    while ((ptr<end) && is_space_(*ptr)) ptr++;
+    const char *value = ptr;
+    ptr = json_value_end(value, end);
+    if (ptr==value) return -1;
+
+    uint32_t slot = json_schema_hash(key, key_len, schema->seed) & schema->mask;
+    int i = schema->slots[slot] - 1;
+    if ((i>=0) && (schema->name_len[i]==key_len) && 
+        (memcmp(schema->fields[i].name, key, key_len)==0)) {
+      set += json_field_set(&schema->fields[i], value, ptr-value, out);
+    }
+  }
+  return set;
+}
+
+
+// ---- validation ----
+// one pass a block at a time with the classifier, like jsonExtractMany: the
+// unescaped quotes give the string mask, and only the bytes that matter are
+// visited. outside strings these are the structural bytes, opening quotes
+// and the first byte of each number or word, which drive the grammar;
+// spacing is never looked at and digit runs come from the digit mask.
+// inside strings they are backslashes, control and non ASCII bytes.
+
+#define JSON_V_VALUE 0 // expecting a value
+#define JSON_V_KEY   1 // expecting a member name
+#define JSON_V_AFTER 2 // after a value: ',', closing bracket or end
+#define JSON_V_COLON 3 // after a member name
+#define JSON_V_FIRST 4 // after '{' or '[': first entry or closing bracket
+
+// length of the valid UTF-8 sequence at ptr, 0 if broken, overlong,
+// a surrogate or above U+10FFFF
+static int json_utf8_check(const unsigned char *ptr, const unsigned char *end) {
+  unsigned char c = ptr[0], lo = 0x80, hi = 0xBF;
+  int len, i;
+  if ((c>=0xC2) && (c<=0xDF)) len = 2;
+  else if ((c>=0xE0) && (c<=0xEF)) {
+    len = 3;
+    if (c==0xE0) lo = 0xA0; // overlong
+    if (c==0xED) hi = 0x9F; // surrogates
+  } else if ((c>=0xF0) && (c<=0xF4)) {
+    len = 4;
+    if (c==0xF0) lo = 0x90; // overlong
+    if (c==0xF4) hi = 0x8F; // above U+10FFFF
+  } else return 0;
+  if (end-ptr<len) return 0;
+  if ((ptr[1]<lo) || (ptr[1]>hi)) return 0;
+  for (i=2; i<len; i++) {
+    if ((ptr[i] & 0xC0)!=0x80) return 0;
+  }
+  return len;
+}
+
+// past the digits at ptr, byte at of a block with digit mask digits (at past
+// the block: not classified); a run reaching the end of the block goes on
+// byte by byte
+static const char *json_skip_digits(const char *ptr, const char *end, uint32_t digits, long at) {
+  if (at<JSON_BLOCK) {
+    uint32_t stop = ~digits >> at;
+    if (stop) return ptr + json_ctz_(stop);
+    ptr += JSON_BLOCK - at;
+  }
+  while ((ptr<end) && is_number_(*ptr)) ptr++;
+  return ptr;
+}
+
+// end of the number at ptr, byte at of a block with digit mask digits, or NULL
+static const char *json_validate_number_at(const char *ptr, const char *end, uint32_t digits, long at) {
+  const char *start = ptr;
+  if ((ptr<end) && (*ptr=='-')) ptr++;
+  if ((ptr<end) && (*ptr=='0')) ptr++;
+  else if ((ptr<end) && is_number_(*ptr)) ptr = json_skip_digits(ptr, end, digits, at + (ptr-start));
+  else return NULL;
+  if ((ptr<end) && (*ptr=='.')) {
+    ptr++;
+    if ((ptr>=end) || !is_number_(*ptr)) return NULL;
+    ptr = json_skip_digits(ptr, end, digits, at + (ptr-start));
+  }
+  if ((ptr<end) && ((*ptr=='e') || (*ptr=='E'))) {
+    ptr++;
+    if ((ptr<end) && ((*ptr=='+') || (*ptr=='-'))) ptr++;
+    if ((ptr>=end) || !is_number_(*ptr)) return NULL;
+    ptr = json_skip_digits(ptr, end, digits, at + (ptr-start));
+  }
+  return ptr;
+}
+
+// end of the number at ptr, or NULL
+static const char *json_validate_number(const char *ptr, const char *end) {
+  return json_validate_number_at(ptr, end, 0, JSON_BLOCK);
+}
+
+// first byte breaking the grammar (end if input stops too early), NULL if valid.
+// a block's string bytes are checked before its grammar bytes: whichever
+// fails first in the text is the error, as the two do not depend on each other
+static const char *json_validate(const char *json, size_t len) {
+  const char *ptr = json, *end = json + len, *skip = json, *next;
+  char stack[JSON_VALIDATE_MAX_DEPTH]; // open brackets
+  int depth = 0, state = JSON_V_VALUE;
+  uint32_t carry = 0, string_mask = 0, word = 0; // word: previous byte is in a number or word
+  char tail[JSON_BLOCK];
+  json_block_t m;
+
+  while (ptr<end) {
+    const char *block = ptr, *bad = NULL;
+    size_t n = end - ptr;
+    if (n<JSON_BLOCK) { // last block, padded with spaces
+      memset(tail, ' ', JSON_BLOCK);
+      memcpy(tail, ptr, n);
+      block = tail;
+    } else n = JSON_BLOCK;
+    json_classify(block, &m);
+    json_stat_(bytes_scanned, n);
+    uint32_t escaped = (m.escape | carry) ? json_escaped(m.escape, &carry) : 0;
+    uint32_t toggles = m.quote & ~escaped;
+    uint32_t inside = json_prefix_xor(toggles) ^ string_mask; // opening quotes included
+    uint32_t words = ~(m.space | m.structural | m.quote | inside);
+    uint32_t checks = inside & ~toggles & ((m.escape & ~escaped) | m.control | m.high);
+    uint32_t hits = (m.structural & ~inside) | (toggles & inside) | (words & ~((words << 1) | word));
+    string_mask = (inside >> 31) ? 0xffffffff : 0;
+    word = words >> 31;
+
+    // in strings: escapes, control bytes and UTF-8
+    while (checks) {
+      const char *hit = ptr + json_ctz_(checks);
+      checks &= checks-1;
+      if (hit<skip) continue; // rest of a UTF-8 sequence
+      if (is_escape_(*hit)) {
+        if ((hit+1<end) && json_unescape_table[(unsigned char)hit[1]]) continue;
+        if ((end-hit>=6) && (hit[1]=='u') && (json_hex4(hit+2)>=0)) continue;
+      } else {
+        int seq = json_utf8_check((const unsigned char *)hit, (const unsigned char *)end);
+        if (seq) { skip = hit + seq; continue; } // control bytes fail here too
+      }
+      bad = hit;
+      hits &= ((uint32_t)1 << (hit-ptr)) - 1;
+      break;
+    }
+
+    // the grammar: structural bytes, opening quotes, numbers and words
+    while (hits) {
+      const char *hit = ptr + json_ctz_(hits);
+      hits &= hits-1;
+      switch (state) {
+      case JSON_V_FIRST:
+        if (*hit==stack[depth-1]+2) { depth--; state = JSON_V_AFTER; continue; } // empty
+        if (stack[depth-1]=='[') break;
+        // fall through
+      case JSON_V_KEY: // the name is checked with the other string bytes
+        if (!is_doublequote_(*hit)) return hit;
+        state = JSON_V_COLON;
+        continue;
+      case JSON_V_COLON:
+        if (*hit!=':') return hit;
+        state = JSON_V_VALUE;
+        continue;
+      case JSON_V_AFTER:
+        if (!depth) return hit;
+        if (*hit==',') state = (stack[depth-1]=='{') ? JSON_V_KEY : JSON_V_VALUE;
+        else if (*hit==stack[depth-1]+2) depth--; // '{'+2 = '}', '['+2 = ']'
+        else return hit;
+        continue;
+      }
+
+      // a value
+      state = JSON_V_AFTER;
+      switch (*hit) {
+      case '{': case '[':
+        if (depth>=JSON_VALIDATE_MAX_DEPTH) return hit;
+        stack[depth++] = *hit;
+        state = JSON_V_FIRST;
+        continue;
+      case '"':
+        continue;
+      case 't': case 'f': case 'n':
+        next = hit;
+        while ((next<end) && is_lower_(*next)) next++;
+        if (json_word_type(hit, next-hit)==JSON_NONE) return hit;
+        break;
+      default:
+        if (!(next = json_validate_number_at(hit, end, m.digit, hit-ptr))) return hit;
+      }
+      // numbers and words end at spacing, a structural byte or a quote
+      if ((next<end) && !(json_class_(*next) & (JSON_SCAN_SPACE | JSON_SCAN_STRUCT | JSON_SCAN_QUOTE))) {
+        return next;
+      }
+    }
+    if (bad) return bad;
+    ptr += n;
+  }
+  if (string_mask || depth || (state!=JSON_V_AFTER)) return end;
+  return NULL;
+}
+
+// check json[0..len) is one complete JSON value (RFC 8259) in valid UTF-8.
+// returns 1=valid, 0=invalid with *err_offset (if not NULL) at the first
+// offending byte, len if the input ends too early
+int jsonValidate(const char *json, size_t len, size_t *err_offset) {
+  const char *err = json_validate(json, len);
+  if (!err) return 1;
+  if (err_offset) *err_offset = err - json;
+  return 0;
+}
+
+// trusted lookups, for input that passed jsonValidate: values end where the
+// grammar says without guarding against broken input
+
+// first member named key_name at any depth, as jsonExtractMany finds it:
+// strings are never taken for names. in valid JSON two strings always have
+// a ',' or ':' between them, so "key_name" found in the text starts at an
+// opening quote or at an escaped quote inside a string, unless the name
+// holds ',' or ':' itself; such names are looked up with string state.
+int jsonExtractSpanTrusted(const char *json, size_t json_len, const char *key_name, 
+    jsonSpan *span) {
+  const char *ptr = json, *end = json + json_len, *value;
+  size_t name_len = json_strlen_(key_name);
+
+  if (strpbrk(key_name, ",:")) {
+    if (jsonExtractMany(json, json_len, &key_name, span, 1)) return 1;
+    return 0;
+  }
+  while ((ptr = json_find_name(ptr, end-ptr, key_name, name_len))) {
+    const char *esc = ptr;
+    while ((esc>json) && is_escape_(esc[-1])) esc--;
+    value = ptr + name_len + 2;
     ptr++;
-    *last_offset = (ptr-buffer);
-    return (key_start-buffer);
+    if ((ptr-1-esc) & 1) continue; // escaped quote inside a string
+    while ((value<end) && is_space_(*value)) value++;
+    if ((value>=end) || (*value!=':')) continue; // a string value, not a name
+    value++;
+    while ((value<end) && is_space_(*value)) value++;
+    span->offset = value - json;
+    span->len = json_value_end(value, end) - value;
+    span->type = json_value_type(value, span->len);
+    return 1;
+  }
+  return 0;
+}
+
+// same as jsonIndexListSpan on a valid list body
+int jsonIndexListSpanTrusted(const char *json, size_t json_len, int index, jsonSpan *span) {
+  const char *ptr = json, *end = json + json_len;
+  while (1) {
+    while ((ptr<end) && is_space_(*ptr)) ptr++;
+    if ((ptr>=end) || is_bracket_close_(*ptr)) return 0;
+    const char *value_end = json_value_end(ptr, end);
+    if (!index--) {
+      span->offset = ptr - json;
+      span->len = value_end - ptr;
+      span->type = json_value_type(ptr, span->len);
+      return 1;
+    }
+    ptr = value_end;
+    while ((ptr<end) && (is_space_(*ptr) || (*ptr==','))) ptr++;
   }
-  //printf("json wonky, restart\n");
-  // broken json, just continue from here
-  return jsonStreamKeyValues(NULL, buffer, max_buffer, (ptr-buffer), last_offset);
 }
 
+
+// ---- arena DOM ----
+// nodes fill the arena from the front in document order, strings from the
+// back, so one buffer serves both without knowing the mix up front.
+
+void jsonDomInit(jsonDom *dom, void *arena, size_t size) {
+  uintptr_t pad = -(uintptr_t)arena & (_Alignof(jsonNode)-1);
+  if (pad>size) pad = size;
+  dom->arena = (char *)arena;
+  dom->size = size;
+  dom->nodes = (jsonNode *)(dom->arena + pad);
+  jsonDomReset(dom);
+}
+
+// drop all parsed documents at once
+void jsonDomReset(jsonDom *dom) {
+  dom->count = 0;
+  dom->top = dom->size;
+  dom->error = 0;
+}
+
+// next free node, NULL if it would run into the strings
+static jsonNode *json_dom_node(jsonDom *dom, jsonType type) {
+  jsonNode *node = dom->nodes + dom->count;
+  if ((char *)(node+1) > dom->arena + dom->top) return NULL;
+  dom->count++;
+  memset(node, 0, sizeof(*node));
+  node->type = type;
+  node->next = -1;
+  return node;
+}
+
+// copy of json string body [ptr, end) unescaped into the arena, NULL if full
+static char *json_dom_string(jsonDom *dom, const char *ptr, const char *end, size_t *len) {
+  size_t need = end - ptr + 1;
+  char *floor = (char *)(dom->nodes + dom->count);
+  if ((need > (size_t)(dom->arena + dom->top - floor)) || (need > INT32_MAX)) return NULL;
+  dom->top -= need;
+  char *dest = dom->arena + dom->top;
+  *len = json_unescape(ptr, end-ptr, dest, need, NULL);
+  return dest;
+}
+
+// build nodes from json that passed json_validate; 1=ok, 0=arena full
+static int json_dom_build(jsonDom *dom, const char *json, size_t len) {
+  const char *ptr = json, *end = json + len, *str;
+  int open[JSON_VALIDATE_MAX_DEPTH]; // open containers
+  int last[JSON_VALIDATE_MAX_DEPTH]; // their latest child, -1 = none yet
+  int depth = 0;
+  const char *key = NULL;
+  size_t key_len = 0;
+
+  while (1) {
+    while ((ptr<end) && (is_space_(*ptr) || (*ptr==','))) ptr++;
+    if (ptr>=end) return 1;
+    if (is_bracket_close_(*ptr)) {
+      depth--; ptr++;
+      continue;
+    }
+    if (depth && (dom->nodes[open[depth-1]].type==JSON_OBJECT) && !key) { // member name
+      str = json_string_end(ptr+1, end);
+      if (!(key = json_dom_string(dom, ptr+1, str-1, &key_len))) return 0;
+      ptr = str;
+      while (is_space_(*ptr) || (*ptr==':')) ptr++;
+    }
+
+    const char *value = ptr;
+    jsonNode *node = json_dom_node(dom, JSON_NONE);
+    if (!node) return 0;
+    int index = node - dom->nodes;
+    node->key = key; node->key_len = key_len;
+    key = NULL;
+    if (depth) {
+      dom->nodes[open[depth-1]].count++;
+      if (last[depth-1]>=0) dom->nodes[last[depth-1]].next = index;
+      last[depth-1] = index;
+    }
+    if (is_bracket_open_(*ptr)) {
+      node->type = (*ptr=='{') ? JSON_OBJECT : JSON_ARRAY;
+      open[depth] = index; last[depth] = -1; depth++;
+      ptr++;
+    } else if (is_doublequote_(*ptr)) {
+      node->type = JSON_STRING;
+      ptr = json_string_end(ptr+1, end);
+      if (!(node->value = json_dom_string(dom, value+1, ptr-1, &node->len))) return 0;
+    } else { // number keeps its text, true, false, null
+      while ((ptr<end) && !(json_class_(*ptr) & (JSON_SCAN_SPACE | JSON_SCAN_STRUCT))) ptr++;
+      node->type = json_word_type(value, ptr-value);
+      if ((node->type==JSON_NUMBER) && 
+          !(node->value = json_dom_string(dom, value, ptr, &node->len))) return 0;
+    }
+    if (!depth) return 1;
+  }
+}
+
+// parse json[0..len) into the arena, after documents parsed before.
+// returns the root node, NULL on error: dom->error is 1 for invalid JSON
+// (dom->error_offset at the offending byte) or -1 if the arena is full,
+// and the arena is left as it was before the call.
+const jsonNode *jsonDomParse(jsonDom *dom, const char *json, size_t len) {
+  int count = dom->count;
+  size_t top = dom->top;
+  const char *err = json_validate(json, len);
+
+  dom->error = 0;
+  if (err) {
+    dom->error = 1;
+    dom->error_offset = err - json;
+    return NULL;
+  }
+  if (!json_dom_build(dom, json, len)) {
+    json_stat_(overfills, 1);
+    dom->count = count;
+    dom->top = top;
+    dom->error = -1;
+    return NULL;
+  }
+  return dom->nodes + count;
+}
+
+// first child of an object or array, NULL if empty or not a container
+const jsonNode *jsonDomChild(const jsonNode *node) {
+  if (!node || !node->count) return NULL;
+  return node+1;
+}
+
+// next member after node in its object or array, NULL after the last
+const jsonNode *jsonDomNext(const jsonDom *dom, const jsonNode *node) {
+  if (!node || (node->next<0)) return NULL;
+  return dom->nodes + node->next;
+}
+
+// value of key in object, NULL if missing. key is matched unescaped
+const jsonNode *jsonDomGet(const jsonDom *dom, const jsonNode *object, const char *key) {
+  if (!object || (object->type!=JSON_OBJECT)) return NULL;
+  size_t key_len = json_strlen_(key);
+  const jsonNode *child = jsonDomChild(object);
+  for (; child; child = jsonDomNext(dom, child)) {
+    if ((child->key_len==key_len) && (memcmp(child->key, key, key_len)==0)) return child;
+  }
+  return NULL;
+}
+
+// n-th member of an array (or object), NULL if out of range
+const jsonNode *jsonDomIndex(const jsonDom *dom, const jsonNode *node, int index) {
+  if (!node || (index<0) || (index>=node->count)) return NULL;
+  const jsonNode *child = jsonDomChild(node);
+  while (index--) child = jsonDomNext(dom, child);
+  return child;
+}
+
+
+
+// ---- binary form ----
+// documents as tagged values with offset tables, so keys and indexes are
+// found without scanning. all integers are little-endian.
+//   null, false, true  tag only
+//   int8/16/32/64      tag, 1/2/4/8 byte two's complement
+//   double             tag, 8 byte IEEE 754
+//   string             tag, varint length, bytes (unescaped)
+//   array, object      tag, items, offsets [, sorted], count, width
+// object members are a string without tag followed by the value. offsets
+// count from the first item, objects add member numbers sorted by key.
+// width (1, 2 or 4) is the size of count and of each table entry, its byte
+// ends the container. nothing up front says where a value ends: its parent
+// knows (next offset, or the tables for the last item), so the encoder
+// writes everything in one pass.
+
+#define JSON_BIN_NULL   0
+#define JSON_BIN_FALSE  1
+#define JSON_BIN_TRUE   2
+#define JSON_BIN_INT8   3
+#define JSON_BIN_INT16  4
+#define JSON_BIN_INT32  5
+#define JSON_BIN_INT64  6
+#define JSON_BIN_DOUBLE 7
+#define JSON_BIN_STRING 8
+#define JSON_BIN_ARRAY  9
+#define JSON_BIN_OBJECT 10
+
+static void json_bin_write(char *ptr, uint64_t value, int width) {
+  int i;
+  for (i=0; i<width; i++) ptr[i] = (char)(value >> (8*i));
+}
+
+static uint64_t json_bin_read(const char *ptr, int width) {
+  const unsigned char *p = (const unsigned char *)ptr;
+  uint64_t value = 0;
+  int i;
+  if (width==1) return p[0]; // table entries, the common case
+  for (i=0; i<width; i++) value |= (uint64_t)p[i] << (8*i);
+  return value;
+}
+
+static int json_varint_len(uint64_t value) {
+  int len = 1;
+  while (value>=0x80) { value >>= 7; len++; }
+  return len;
+}
+
+static void json_varint_write(char *ptr, uint64_t value) {
+  while (value>=0x80) { *ptr++ = (char)(value | 0x80); value >>= 7; }
+  *ptr = (char)value;
+}
+
+// string bytes at ptr (after any tag), their length in *len
+static const char *json_bin_string(const char *ptr, size_t *len) {
+  uint64_t value = 0;
+  int shift = 0;
+  while ((unsigned char)*ptr & 0x80) {
+    value |= (uint64_t)(*ptr & 0x7f) << shift;
+    ptr++; shift += 7;
+  }
+  *len = value | (uint64_t)(unsigned char)*ptr << shift;
+  return ptr+1;
+}
+
+static jsonType json_bin_type(const char *ptr) {
+  switch (*ptr) {
+  case JSON_BIN_NULL: return JSON_NULL;
+  case JSON_BIN_FALSE: return JSON_FALSE;
+  case JSON_BIN_TRUE: return JSON_TRUE;
+  case JSON_BIN_STRING: return JSON_STRING;
+  case JSON_BIN_ARRAY: return JSON_ARRAY;
+  case JSON_BIN_OBJECT: return JSON_OBJECT;
+  default: return JSON_NUMBER;
+  }
+}
+
+// the tables of a container
+typedef struct {
+  const char *items;    // first item, offsets count from here
+  const char *offsets;  // also where the last item ends
+  const char *sorted;   // objects: member numbers by key
+  size_t count;
+  int width;
+} json_bin_table_t;
+
+static void json_bin_table(const char *bin, const jsonSpan *span, json_bin_table_t *table) {
+  const char *end = bin + span->offset + span->len;
+  int tables = (span->type==JSON_OBJECT) ? 2 : 1;
+  table->width = (unsigned char)end[-1];
+  table->count = json_bin_read(end - 1 - table->width, table->width);
+  table->offsets = end - 1 - table->width - table->count*table->width*tables;
+  table->sorted = table->offsets + table->count*table->width;
+  table->items = bin + span->offset + 1;
+}
+
+// start of item i, its end in *end
+static const char *json_bin_item(const json_bin_table_t *table, size_t i, const char **end) {
+  int width = table->width;
+  *end = (i+1 < table->count) ? 
+      table->items + json_bin_read(table->offsets + (i+1)*width, width) : table->offsets;
+  return table->items + json_bin_read(table->offsets + i*width, width);
+}
+
+static void json_bin_span(const char *bin, const char *ptr, const char *end, jsonSpan *span) {
+  span->offset = ptr - bin;
+  span->len = end - ptr;
+  span->type = json_bin_type(ptr);
+}
+
+// name of member n
+static const char *json_bin_name(const json_bin_table_t *table, uint64_t n, size_t *len) {
+  return json_bin_string(table->items + 
+      json_bin_read(table->offsets + n*table->width, table->width), len);
+}
+
+// order of members a and b in the sorted table: by key bytes, equal keys
+// in document order so a search finds the first one
+static int json_bin_key_cmp(const json_bin_table_t *table, uint64_t a, uint64_t b) {
+  size_t a_len, b_len;
+  const char *a_key = json_bin_name(table, a, &a_len), *b_key = json_bin_name(table, b, &b_len);
+  int cmp = memcmp(a_key, b_key, (a_len<b_len) ? a_len : b_len);
+  if (cmp) return cmp;
+  if (a_len!=b_len) return (a_len<b_len) ? -1 : 1;
+  return (a<b) ? -1 : (a>b);
+}
+
+// heap sort of the member numbers in sorted
+static void json_bin_sort(const json_bin_table_t *table, char *sorted) {
+  size_t start = table->count/2, end = table->count;
+  int width = table->width;
+  while (end>1) {
+    if (start>0) start--;
+    else { // move the largest to the end
+      uint64_t last = json_bin_read(sorted + (end-1)*width, width);
+      end--;
+      json_bin_write(sorted + end*width, json_bin_read(sorted, width), width);
+      json_bin_write(sorted, last, width);
+    }
+    size_t root = start; // sift down
+    while (2*root+1 < end) {
+      size_t child = 2*root+1;
+      uint64_t child_n = json_bin_read(sorted + child*width, width);
+      if (child+1 < end) {
+        uint64_t right = json_bin_read(sorted + (child+1)*width, width);
+        if (json_bin_key_cmp(table, child_n, right)<0) { child++; child_n = right; }
+      }
+      uint64_t root_n = json_bin_read(sorted + root*width, width);
+      if (json_bin_key_cmp(table, root_n, child_n)>=0) break;
+      json_bin_write(sorted + root*width, child_n, width);
+      json_bin_write(sorted + child*width, root_n, width);
+      root = child;
+    }
+  }
+}
+
+// output, item offsets of open containers are stacked at the end of dest
+typedef struct {
+  char *dest;
+  size_t size;
+  size_t len;
+  size_t pending;   // offsets on the stack
+} json_bin_out;
+
+#define json_bin_room_(out) ((out)->size - (out)->pending*4 - (out)->len)
+
+// tagless string: varint length and the unescaped body [ptr, end)
+static int json_bin_put_string(json_bin_out *out, const char *ptr, const char *end) {
+  size_t raw = end - ptr;
+  int raw_vlen = json_varint_len(raw);
+  if ((raw > INT32_MAX-1) || (json_bin_room_(out) < raw_vlen + raw + 1)) return 0; // + '\0'
+  char *dest = out->dest + out->len;
+  size_t len = json_unescape(ptr, raw, dest + raw_vlen, raw + 1, NULL);
+  int vlen = json_varint_len(len);
+  if (vlen<raw_vlen) memmove(dest + vlen, dest + raw_vlen, len);
+  json_varint_write(dest, len);
+  out->len += vlen + len;
+  return 1;
+}
+
+static int json_bin_put_number(json_bin_out *out, const char *ptr, size_t len) {
+  int64_t int_value;
+  double double_value;
+  uint64_t bits;
+  char tag = JSON_BIN_INT64;
+  int width = 8;
+  if (jsonParseInt64(ptr, len, &int_value) && (int_value || (*ptr!='-'))) { // -0 stays a double
+    if ((int_value>=INT8_MIN) && (int_value<=INT8_MAX)) { tag = JSON_BIN_INT8; width = 1; }
+    else if ((int_value>=INT16_MIN) && (int_value<=INT16_MAX)) { tag = JSON_BIN_INT16; width = 2; }
+    else if ((int_value>=INT32_MIN) && (int_value<=INT32_MAX)) { tag = JSON_BIN_INT32; width = 4; }
+    bits = (uint64_t)int_value;
+  } else {
+    jsonParseDouble(ptr, len, &double_value);
+    memcpy(&bits, &double_value, sizeof(bits));
+    tag = JSON_BIN_DOUBLE;
+  }
+  if (json_bin_room_(out) < 1 + (size_t)width) return 0;
+  out->dest[out->len] = tag;
+  json_bin_write(out->dest + out->len + 1, bits, width);
+  out->len += 1 + width;
+  return 1;
+}
+
+// finish the container whose tag is at start and whose count item offsets
+// are on top of the stack: write its tables
+static int json_bin_close(json_bin_out *out, size_t start, size_t count) {
+  json_bin_table_t table;
+  size_t items_len = out->len - (start+1), i;
+  int is_object = (out->dest[start]==JSON_BIN_OBJECT);
+  int width = (items_len<=0xff) ? 1 : (items_len<=0xffff) ? 2 : 4;
+  size_t tables_len = count*width*(is_object ? 2 : 1);
+  if ((items_len>UINT32_MAX) || (json_bin_room_(out) < tables_len + width + 1)) return 0;
+
+  const char *stack = out->dest + out->size - out->pending*4; // last pushed first
+  char *ptr = out->dest + out->len;
+  for (i=0; i<count; i++) {
+    json_bin_write(ptr + i*width, json_bin_read(stack + (count-1-i)*4, 4), width);
+  }
+  out->pending -= count;
+  table.items = out->dest + start + 1;
+  table.offsets = ptr;
+  table.count = count;
+  table.width = width;
+  ptr += count*width;
+  if (is_object) {
+    for (i=0; i<count; i++) json_bin_write(ptr + i*width, i, width);
+    json_bin_sort(&table, ptr);
+    ptr += count*width;
+  }
+  json_bin_write(ptr, count, width);
+  ptr[width] = (char)width;
+  out->len += tables_len + width + 1;
+  return 1;
+}
+
+// encode json that passed json_validate; 1=ok, 0=out of room
+static int json_bin_encode(json_bin_out *out, const char *json, size_t len) {
+  const char *ptr = json, *end = json + len, *value;
+  size_t open[JSON_VALIDATE_MAX_DEPTH]; // tag positions of open containers
+  size_t count[JSON_VALIDATE_MAX_DEPTH];
+  int depth = 0;
+
+  while (1) {
+    while ((ptr<end) && (is_space_(*ptr) || (*ptr==','))) ptr++;
+    if (ptr>=end) return 1;
+    if (is_bracket_close_(*ptr)) {
+      depth--; ptr++;
+      if (!json_bin_close(out, open[depth], count[depth])) return 0;
+      if (!depth) return 1;
+      continue;
+    }
+    if (depth) { // push offset of the new item
+      size_t offset = out->len - (open[depth-1]+1);
+      if ((offset>UINT32_MAX) || (json_bin_room_(out) < 4)) return 0;
+      out->pending++;
+      json_bin_write(out->dest + out->size - out->pending*4, offset, 4);
+      count[depth-1]++;
+      if (out->dest[open[depth-1]]==JSON_BIN_OBJECT) { // member name
+        value = json_string_end(ptr+1, end);
+        if (!json_bin_put_string(out, ptr+1, value-1)) return 0;
+        ptr = value;
+        while (is_space_(*ptr) || (*ptr==':')) ptr++;
+      }
+    }
+
+    value = ptr;
+    if (!json_bin_room_(out)) return 0;
+    if (is_bracket_open_(*ptr)) {
+      open[depth] = out->len; count[depth] = 0; depth++;
+      out->dest[out->len++] = (*ptr=='{') ? JSON_BIN_OBJECT : JSON_BIN_ARRAY;
+      ptr++;
+      continue;
+    }
+    if (is_doublequote_(*ptr)) {
+      ptr = json_string_end(ptr+1, end);
+      out->dest[out->len++] = JSON_BIN_STRING;
+      if (!json_bin_put_string(out, value+1, ptr-1)) return 0;
+    } else {
+      while ((ptr<end) && !(json_class_(*ptr) & (JSON_SCAN_SPACE | JSON_SCAN_STRUCT))) ptr++;
+      jsonType type = json_word_type(value, ptr-value);
+      if (type==JSON_NUMBER) {
+        if (!json_bin_put_number(out, value, ptr-value)) return 0;
+      } else {
+        out->dest[out->len++] = (type==JSON_TRUE) ? JSON_BIN_TRUE : 
+            (type==JSON_FALSE) ? JSON_BIN_FALSE : JSON_BIN_NULL;
+      }
+    }
+    if (!depth) return 1;
+  }
+}
+
+// convert json[0..len) to the binary form in dest. while encoding dest
+// also holds 4 bytes per item of each unfinished container.
+// returns bytes used, 0=invalid JSON, -1=dest too small
+long jsonBinEncode(const char *json, size_t len, char *dest, size_t size) {
+  json_bin_out out = { dest, size, 0, 0 };
+  if (json_validate(json, len)) return 0;
+  if (!json_bin_encode(&out, json, len)) {
+    json_stat_(overfills, 1);
+    return -1;
+  }
+  return out.len;
+}
+
+// span of the value in bin[0..len); returns 1=ok, 0=empty
+int jsonBinRoot(const char *bin, size_t len, jsonSpan *span) {
+  if (!len) return 0;
+  json_bin_span(bin, bin, bin + len, span);
+  return 1;
+}
+
+// number of items of an array or members of an object, 0 otherwise
+int jsonBinCount(const char *bin, const jsonSpan *span) {
+  json_bin_table_t table;
+  if ((span->type!=JSON_ARRAY) && (span->type!=JSON_OBJECT)) return 0;
+  json_bin_table(bin, span, &table);
+  return table.count;
+}
+
+// member i of a table: name span (unescaped bytes in bin) and value
+static void json_bin_member(const char *bin, const json_bin_table_t *table, size_t i, 
+    jsonSpan *key, jsonSpan *value) {
+  const char *end, *name = json_bin_item(table, i, &end);
+  size_t len;
+  name = json_bin_string(name, &len);
+  key->offset = name - bin;
+  key->len = len;
+  key->type = JSON_STRING;
+  json_bin_span(bin, name + len, end, value);
+}
+
+// index-th member of an object in document order.
+// returns 1=ok, 0=no such member or not an object
+int jsonBinMember(const char *bin, const jsonSpan *object, int index, 
+    jsonSpan *key, jsonSpan *value) {
+  json_bin_table_t table;
+  if (object->type!=JSON_OBJECT) return 0;
+  json_bin_table(bin, object, &table);
+  if ((index<0) || ((size_t)index>=table.count)) return 0;
+  json_bin_member(bin, &table, index, key, value);
+  return 1;
+}
+
+// value of the first member named name (unescaped), by binary search.
+// returns 1=found, 0=not found or not an object
+int jsonBinGet(const char *bin, const jsonSpan *object, const char *name, jsonSpan *value) {
+  json_bin_table_t table;
+  jsonSpan key;
+  const char *key_name;
+  size_t name_len = json_strlen_(name), low = 0, high, len;
+  uint64_t n = 0;
+  if (object->type!=JSON_OBJECT) return 0;
+  json_bin_table(bin, object, &table);
+  high = table.count;
+  while (low<high) { // first member not below name
+    size_t mid = low + (high-low)/2;
+    n = json_bin_read(table.sorted + mid*table.width, table.width);
+    key_name = json_bin_name(&table, n, &len);
+    int cmp = memcmp(key_name, name, (len<name_len) ? len : name_len);
+    if ((cmp<0) || (!cmp && (len<name_len))) low = mid+1;
+    else high = mid;
+  }
+  if (low>=table.count) return 0;
+  n = json_bin_read(table.sorted + low*table.width, table.width);
+  key_name = json_bin_name(&table, n, &len);
+  if ((len!=name_len) || memcmp(key_name, name, len)) return 0;
+  json_bin_member(bin, &table, n, &key, value);
+  return 1;
+}
+
+// index-th item of an array, or value of the index-th object member.
+// returns 1=ok, 0=out of range or not a container
+int jsonBinIndex(const char *bin, const jsonSpan *list, int index, jsonSpan *item) {
+  json_bin_table_t table;
+  jsonSpan key;
+  const char *ptr, *end;
+  if (list->type==JSON_OBJECT) return jsonBinMember(bin, list, index, &key, item);
+  if (list->type!=JSON_ARRAY) return 0;
+  json_bin_table(bin, list, &table);
+  if ((index<0) || ((size_t)index>=table.count)) return 0;
+  ptr = json_bin_item(&table, index, &end);
+  json_bin_span(bin, ptr, end, item);
+  return 1;
+}
+
+// decode a scalar: numbers, booleans; strings get the span of their bytes
+jsonType jsonBinValue(const char *bin, const jsonSpan *span, jsonValue *value) {
+  const char *ptr = bin + span->offset;
+  uint64_t bits;
+  size_t len;
+  memset(value, 0, sizeof(*value));
+  value->span = *span;
+  value->type = span->type;
+  switch (*ptr) {
+  case JSON_BIN_TRUE: value->bool_value = 1; break;
+  case JSON_BIN_INT8: value->int_value = (int8_t)ptr[1]; break;
+  case JSON_BIN_INT16: value->int_value = (int16_t)json_bin_read(ptr+1, 2); break;
+  case JSON_BIN_INT32: value->int_value = (int32_t)json_bin_read(ptr+1, 4); break;
+  case JSON_BIN_INT64: value->int_value = (int64_t)json_bin_read(ptr+1, 8); break;
+  case JSON_BIN_DOUBLE:
+    bits = json_bin_read(ptr+1, 8);
+    memcpy(&value->double_value, &bits, sizeof(bits));
+    break;
+  case JSON_BIN_STRING:
+    value->span.offset = json_bin_string(ptr+1, &len) - bin;
+    value->span.len = len;
+    break;
+  }
+  if ((*ptr>=JSON_BIN_INT8) && (*ptr<=JSON_BIN_INT64)) {
+    value->is_int = 1;
+    value->double_value = (double)value->int_value;
+  }
+  return value->type;
+}
+
+typedef struct {
+  char *dest;
+  size_t size;      // room for text, without the '\0'
+  size_t written;
+  size_t len;       // full length of the text
+  int cut;          // once something is left out, nothing after it is written
+} json_text_out;
+
+static void json_text_put(json_text_out *out, const char *data, size_t len) {
+  if (!out->cut && (len <= out->size - out->written)) {
+    memcpy(out->dest + out->written, data, len);
+    out->written += len;
+  } else out->cut = 1;
+  out->len += len;
+}
+
+static void json_text_string(json_text_out *out, const char *ptr, size_t len) {
+  json_text_put(out, "\"", 1);
+  if (!out->cut) {
+    size_t room = out->size - out->written;
+    size_t n = jsonEscapeTo(ptr, len, out->dest + out->written, room+1);
+    if (n<=room) out->written += n;
+    else out->cut = 1;
+    out->len += n;
+  } else out->len += jsonEscapeTo(ptr, len, NULL, 0);
+  json_text_put(out, "\"", 1);
+}
+
+static void json_bin_text(json_text_out *out, const char *bin, const jsonSpan *span) {
+  json_bin_table_t table;
+  jsonValue value;
+  jsonSpan key, item;
+  char buff[32];
+  size_t i;
+  int len;
+
+  switch (jsonBinValue(bin, span, &value)) {
+  case JSON_NULL: json_text_put(out, "null", 4); break;
+  case JSON_TRUE: json_text_put(out, "true", 4); break;
+  case JSON_FALSE: json_text_put(out, "false", 5); break;
+  case JSON_STRING: json_text_string(out, bin + value.span.offset, value.span.len); break;
+  case JSON_NUMBER:
+    if (value.is_int) len = snprintf(buff, sizeof(buff), "%lld", (long long)value.int_value);
+    else if (value.double_value-value.double_value!=0) { // beyond double range
+      len = snprintf(buff, sizeof(buff), "%s1e999", (value.double_value<0) ? "-" : "");
+    } else {
+      len = json_double_text(buff, sizeof(buff), value.double_value);
+    }
+    json_text_put(out, buff, len);
+    break;
+  case JSON_ARRAY: case JSON_OBJECT:
+    json_text_put(out, (span->type==JSON_OBJECT) ? "{" : "[", 1);
+    json_bin_table(bin, span, &table);
+    for (i=0; i<table.count; i++) {
+      if (i) json_text_put(out, ",", 1);
+      if (span->type==JSON_OBJECT) {
+        json_bin_member(bin, &table, i, &key, &item);
+        json_text_string(out, bin + key.offset, key.len);
+        json_text_put(out, ":", 1);
+      } else {
+        const char *end, *ptr = json_bin_item(&table, i, &end);
+        json_bin_span(bin, ptr, end, &item);
+      }
+      json_bin_text(out, bin, &item);
+    }
+    json_text_put(out, (span->type==JSON_OBJECT) ? "}" : "]", 1);
+    break;
+  default: break;
+  }
+}
+
+// the value at span as compact JSON text in dest ('\0' terminated).
+// returns the full length like snprintf: >= size means it was cut
+long jsonBinDecode(const char *bin, const jsonSpan *span, char *dest, size_t size) {
+  json_text_out out = { dest, (dest && size) ? size-1 : 0, 0, 0, !dest || !size };
+  json_bin_text(&out, bin, span);
+  if (dest && size) dest[out.written] = '\0';
+  return out.len;
+}
+
+// ---- streaming minifier ----
+// jsonRemoveSpacing over input fed in chunks of any size; the string and
+// escape state carries from one chunk to the next.
+
+#define JSON_MINIFY_BUFFER 4096
+
+void jsonMinifyInit(jsonMinify *minify, jsonWriteFn write, void *ctx) {
+  memset(minify, 0, sizeof(*minify));
+  minify->write = write;
+  minify->ctx = ctx;
+}
+
+// minify one chunk into dest (room for len bytes, may be chunk), returns length
+size_t jsonMinifyChunk(jsonMinify *minify, const char *chunk, size_t len, char *dest) {
+  return json_remove_spacing(chunk, len, dest, &minify->in_string, &minify->escaped);
+}
+
+// minify one chunk through a fixed stack buffer to minify->write.
+// returns 1, or 0 once write has failed
+int jsonMinifyWrite(jsonMinify *minify, const char *chunk, size_t len) {
+  char buf[JSON_MINIFY_BUFFER];
+  while (len && !minify->error) {
+    size_t part = (len<sizeof(buf)) ? len : sizeof(buf);
+    size_t n = jsonMinifyChunk(minify, chunk, part, buf);
+    if (n && !minify->write(minify->ctx, buf, n)) minify->error = 1;
+    chunk += part;
+    len -= part;
+  }
+  return !minify->error;
+}
+
+// 1 if all output was written and the input did not end inside a string
+int jsonMinifyEnd(const jsonMinify *minify) {
+  return !minify->error && !minify->in_string && !minify->escaped;
+}
+
+// ---- key projection ----
+// streaming filter over root objects: members whose name is (allow list) or
+// is not (deny list) in keys are copied verbatim, the rest dropped. names
+// compare as written, like jsonExtract. other root values pass through.
+
+enum { JSON_P_ROOT, JSON_P_OPEN, JSON_P_NAME_WAIT, JSON_P_NAME, JSON_P_COLON,
+  JSON_P_VALUE_WAIT, JSON_P_VALUE, JSON_P_AFTER };
+
+void jsonProjectInit(jsonProject *project, const char **keys, int key_count,
+    int deny, jsonWriteFn write, void *ctx) {
+  memset(project, 0, sizeof(*project));
+  project->keys = keys;
+  project->key_count = key_count;
+  project->deny = deny;
+  project->write = write;
+  project->ctx = ctx;
+}
+
+typedef struct {
+  jsonProject *project;
+  size_t len;
+  char buf[JSON_MINIFY_BUFFER];
+} json_project_out;
+
+// buffer output, runs that do not fit go straight to write
+static void json_project_put(json_project_out *out, const char *data, size_t len) {
+  jsonProject *project = out->project;
+  if (project->error) return;
+  if (out->len + len > sizeof(out->buf)) {
+    if (out->len && !project->write(project->ctx, out->buf, out->len)) { project->error = -1; return; }
+    out->len = 0;
+    if (len > sizeof(out->buf)) {
+      if (!project->write(project->ctx, data, len)) project->error = -1;
+      return;
+    }
+  }
+  memcpy(out->buf + out->len, data, len);
+  out->len += len;
+}
+
+// name decided: start the member in the output if it is kept
+static void json_project_member(jsonProject *project, json_project_out *out, int match) {
+  project->decided = 1;
+  project->keep = (match != project->deny);
+  if (!project->keep) return;
+  json_project_put(out, (project->first) ? "\"" : ",\"", (project->first) ? 1 : 2);
+  project->first = 0;
+  json_project_put(out, project->name, project->name_len);
+}
+
+static int json_project_match(const jsonProject *project) {
+  int i;
+  for (i=0; i<project->key_count; i++) {
+    if ((json_strlen_(project->keys[i])==project->name_len) &&
+        (memcmp(project->keys[i], project->name, project->name_len)==0)) return 1;
+  }
+  return 0;
+}
+
+// feed one chunk; returns 1, or 0 on invalid JSON (error 1) or a failed write (error -1)
+int jsonProjectWrite(jsonProject *project, const char *chunk, size_t len) {
+  const char *p = chunk, *end = chunk + len;
+  json_project_out out;
+  out.project = project;
+  out.len = 0;
+
+  while ((p<end) && !project->error) {
+    char ch = *p;
+    switch (project->state) {
+    case JSON_P_ROOT: // between root values, spacing passes through
+      if (ch=='{') {
+        json_project_put(&out, p, 1);
+        project->state = JSON_P_OPEN;
+        project->first = 1;
+        project->member = 1;
+        p++;
+      } else if (is_space_(ch)) {
+        json_project_put(&out, p, 1);
+        p++;
+      } else if ((json_class_(ch) & JSON_SCAN_STRUCT) && (ch!='[')) {
+        project->error = 1;
+      } else { // not an object: the whole value is kept
+        project->state = JSON_P_VALUE;
+        project->keep = 1;
+        project->member = 0;
+      }
+      break;
+
+    case JSON_P_OPEN: // '}' after '{' or a value, a name after '{' or ','
+    case JSON_P_NAME_WAIT:
+    case JSON_P_AFTER:
+      if (is_space_(ch)) p++;
+      else if ((ch=='}') && (project->state!=JSON_P_NAME_WAIT)) {
+        json_project_put(&out, p, 1);
+        project->state = JSON_P_ROOT;
+        p++;
+      } else if ((project->state==JSON_P_AFTER) && (ch==',')) {
+        project->state = JSON_P_NAME_WAIT;
+        p++;
+      } else if ((project->state!=JSON_P_AFTER) && is_doublequote_(ch)) {
+        project->state = JSON_P_NAME;
+        project->name_len = 0;
+        project->decided = 0;
+        p++;
+      } else project->error = 1;
+      break;
+
+    case JSON_P_NAME:
+      if (project->escaped) project->escaped = 0;
+      else if (is_escape_(ch)) project->escaped = 1;
+      else if (is_doublequote_(ch)) {
+        if (!project->decided) json_project_member(project, &out, json_project_match(project));
+        if (project->keep) json_project_put(&out, "\":", 2);
+        project->state = JSON_P_COLON;
+        p++;
+        break;
+      }
+      if (project->decided) {
+        if (project->keep) json_project_put(&out, p, 1);
+      } else if (project->name_len < sizeof(project->name)) {
+        project->name[project->name_len++] = ch;
+      } else { // longer than any name we look for
+        json_project_member(project, &out, 0);
+        if (project->keep) json_project_put(&out, p, 1);
+      }
+      p++;
+      break;
+
+    case JSON_P_COLON:
+      if (is_space_(ch)) p++;
+      else if (ch==':') { project->state = JSON_P_VALUE_WAIT; p++; }
+      else project->error = 1;
+      break;
+
+    case JSON_P_VALUE_WAIT:
+      if (is_space_(ch)) p++;
+      else if ((json_class_(ch) & JSON_SCAN_STRUCT) && (ch!='{') && (ch!='[')) project->error = 1;
+      else project->state = JSON_P_VALUE;
+      break;
+
+    case JSON_P_VALUE: { // copied or dropped as written, spacing included
+      int classes = JSON_SCAN_QUOTE | JSON_SCAN_ESCAPE;
+      if (!project->in_string) {
+        classes = JSON_SCAN_QUOTE | JSON_SCAN_STRUCT | ((project->depth) ? 0 : JSON_SCAN_SPACE);
+      }
+      if (project->escaped) project->escaped = 0;
+      else if (!(json_class_(ch) & classes)) { // a run of plain bytes
+        const char *run = json_scan(p, end, classes);
+        if (project->keep) json_project_put(&out, p, run-p);
+        p = run;
+        break;
+      } else if (project->in_string) {
+        if (is_escape_(ch)) project->escaped = 1;
+        else project->in_string = 0;
+      } else if (is_doublequote_(ch)) project->in_string = 1;
+      else if ((ch=='{') || (ch=='[')) project->depth++;
+      else if (project->depth==0) { // ',', '}', ']', ':' or spacing ends it, not consumed
+        if (ch==':') project->error = 1;
+        project->state = (project->member) ? JSON_P_AFTER : JSON_P_ROOT;
+        break;
+      } else if ((ch=='}') || (ch==']')) project->depth--;
+      if (project->keep) json_project_put(&out, p, 1);
+      p++;
+      if (!project->in_string && !project->depth && (json_class_(ch) & (JSON_SCAN_QUOTE|JSON_SCAN_STRUCT))) {
+        project->state = (project->member) ? JSON_P_AFTER : JSON_P_ROOT;
+      }
+      break;
+    }
+    }
+  }
+  // output up to an invalid byte is still written
+  if (out.len && (project->error!=-1) && !project->write(project->ctx, out.buf, out.len)) project->error = -1;
+  return !project->error;
+}
+
+// 1 if the input ended after a complete root value and all output was written
+int jsonProjectEnd(const jsonProject *project) {
+  if (project->error) return 0;
+  if (project->state==JSON_P_ROOT) return 1;
+  return (project->state==JSON_P_VALUE) && !project->member && !project->depth && !project->in_string;
+}
+
+#ifndef JSON_NO_THREADS
+// ---- parallel array split ----
+// top level elements of one large array found by several threads. pass 1
+// summarizes each chunk for both guesses of its string state (inside or
+// outside), a serial prefix fixes the real state at every chunk start, and
+// pass 2 finds the separating commas. input must be valid JSON.
+
+#define JSON_SPLIT_MIN_CHUNK (1 << 16)
+#define JSON_SPLIT_MAX_THREADS 64 // more are clamped, the state is on the stack
+
+typedef struct {
+  int in_string, escaped;
+  long depth;
+} json_split_state;
+
+// string parity and depth change of a chunk, starting outside (delta[0])
+// or inside (delta[1]) a string. a backslash just before the chunk escapes
+// its first byte: backslashes only appear in strings
+static void json_split_summary(const char *start, const char *p, const char *end,
+    int *quotes, long delta[2]) {
+  const char *back = p;
+  uint32_t carry = 0, string_mask = 0;
+  json_block_t m;
+
+  while ((back>start) && is_escape_(back[-1])) back--;
+  carry = (p-back) & 1;
+  delta[0] = delta[1] = 0;
+  while (end-p >= JSON_BLOCK) {
+    json_classify(p, &m);
+    uint32_t inside = json_prefix_xor(m.quote & ~json_escaped(m.escape, &carry)) ^ string_mask;
+    uint32_t s = m.structural;
+    while (s) { // each structural byte is outside a string for exactly one guess
+      int i = json_ctz_(s);
+      char c = p[i];
+      if ((c=='{') || (c=='[')) delta[(inside >> i) & 1]++;
+      else if ((c=='}') || (c==']')) delta[(inside >> i) & 1]--;
+      s &= s-1;
+    }
+    string_mask = (inside >> 31) ? 0xffffffff : 0;
+    p += JSON_BLOCK;
+  }
+  int inside = string_mask & 1, esc = carry;
+  for (; p<end; p++) {
+    if (esc) esc = 0;
+    else if (is_escape_(*p)) esc = 1;
+    else if (is_doublequote_(*p)) inside = !inside;
+    else if ((*p=='{') || (*p=='[')) delta[inside]++;
+    else if ((*p=='}') || (*p==']')) delta[inside]--;
+  }
+  *quotes = inside;
+}
+
+// next top level comma in [p, end) from state st, or end.
+// st is updated to the returned position; after a comma it is all 0
+static const char *json_split_next(const char *p, const char *end, json_split_state *st) {
+  uint32_t carry = st->escaped, string_mask = (st->in_string) ? 0xffffffff : 0;
+  long depth = st->depth;
+  json_block_t m;
+
+  while (end-p >= JSON_BLOCK) {
+    json_classify(p, &m);
+    uint32_t inside = json_prefix_xor(m.quote & ~json_escaped(m.escape, &carry)) ^ string_mask;
+    uint32_t s = m.structural & ~inside;
+    while (s) {
+      int i = json_ctz_(s);
+      char c = p[i];
+      if ((c=='{') || (c=='[')) depth++;
+      else if ((c=='}') || (c==']')) depth--;
+      else if ((c==',') && !depth) {
+        st->in_string = st->escaped = 0;
+        st->depth = 0;
+        return p+i;
+      }
+      s &= s-1;
+    }
+    string_mask = (inside >> 31) ? 0xffffffff : 0;
+    p += JSON_BLOCK;
+  }
+  int inside = string_mask & 1, esc = carry;
+  for (; p<end; p++) {
+    if (esc) esc = 0;
+    else if (is_escape_(*p)) esc = 1;
+    else if (is_doublequote_(*p)) inside = !inside;
+    else if (inside) continue;
+    else if ((*p=='{') || (*p=='[')) depth++;
+    else if ((*p=='}') || (*p==']')) depth--;
+    else if ((*p==',') && !depth) {
+      st->in_string = st->escaped = 0;
+      st->depth = 0;
+      return p;
+    }
+  }
+  st->in_string = inside;
+  st->escaped = esc;
+  st->depth = depth;
+  return end;
+}
+
+typedef struct {
+  const char *json;
+  const char *start, *end;  // inside the brackets
+  int chunks;
+  const char **bounds;      // chunk i is [bounds[i], bounds[i+1])
+  json_split_state *states; // at each chunk start
+  int *quotes;
+  long *delta;              // 2 per chunk
+  jsonElementFn fn;
+  void *ctx;
+  int stop;                 // callback returned 0 or an element was empty
+  int error;                // set with __atomic, workers share them
+} json_split_job;
+
+typedef struct {
+  json_split_job *job;
+  int index;
+  int pass;
+  int started;              // running in its own thread
+  long count;
+} json_split_worker;
+
+// element between two separators (exclusive) to the callback
+static int json_split_emit(json_split_job *job, const char *from, const char *to) {
+  jsonSpan span;
+  while ((from<to) && is_space_(*from)) from++;
+  while ((to>from) && is_space_(to[-1])) to--;
+  if (from==to) {
+    __atomic_store_n(&job->error, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&job->stop, 1, __ATOMIC_RELAXED);
+    return 0;
+  }
+  span.offset = from - job->json;
+  span.len = to - from;
+  span.type = json_value_type(from, span.len);
+  if (!job->fn(job->ctx, job->json, &span)) { __atomic_store_n(&job->stop, 1, __ATOMIC_RELAXED); return 0; }
+  return 1;
+}
+
+// elements that start in chunk i; the last one may end in a later chunk
+static long json_split_elements(json_split_job *job, int i) {
+  const char *p = job->bounds[i], *end = job->bounds[i+1], *from;
+  json_split_state st = job->states[i];
+  long count = 0;
+
+  if (i==0) from = p;
+  else { // elements start after this chunk's first comma
+    const char *comma = json_split_next(p, end, &st);
+    if (comma>=end) return 0;
+    from = p = comma+1;
+  }
+  int own = i; // chunk this worker owns
+  while (!__atomic_load_n(&job->stop, __ATOMIC_RELAXED)) {
+    const char *comma = json_split_next(p, end, &st);
+    if (comma<end) {
+      if (json_split_emit(job, from, comma)) count++;
+      if (i>own) break; // the rest belongs to chunk i's worker
+      from = p = comma+1;
+      continue;
+    }
+    if (end==job->end) { // last element of the array
+      if (json_split_emit(job, from, end)) count++;
+      break;
+    }
+    st = job->states[++i]; // carry on to the next comma
+    p = end;
+    end = job->bounds[i+1];
+  }
+  return count;
+}
+
+static void *json_split_worker_run(void *arg) {
+  json_split_worker *w = arg;
+  json_split_job *job = w->job;
+  int i = w->index;
+  if (w->pass==1) {
+    json_split_summary(job->start, job->bounds[i], job->bounds[i+1], &job->quotes[i], &job->delta[2*i]);
+  } else {
+    w->count = json_split_elements(job, i);
+  }
+  return NULL;
+}
+
+// chunk 0 runs on the calling thread
+static void json_split_pass(json_split_job *job, json_split_worker *workers, pthread_t *tids, int pass) {
+  int i;
+  for (i=0; i<job->chunks; i++) {
+    workers[i].job = job;
+    workers[i].index = i;
+    workers[i].pass = pass;
+    workers[i].count = 0;
+    workers[i].started = (i>0) && !pthread_create(&tids[i], NULL, json_split_worker_run, &workers[i]);
+    if ((i>0) && !workers[i].started) json_split_worker_run(&workers[i]); // no thread: do it here
+  }
+  json_split_worker_run(&workers[0]);
+  for (i=1; i<job->chunks; i++) if (workers[i].started) pthread_join(tids[i], NULL);
+}
+
+static long json_split_array(const char *json, size_t len, int threads, size_t min_chunk,
+    jsonElementFn fn, void *ctx) {
+  json_split_job job;
+  const char *start = json, *end = json + len;
+  long count = 0, depth = 0;
+  int in_string = 0, i;
+
+  while ((start<end) && is_space_(*start)) start++;
+  while ((end>start) && is_space_(end[-1])) end--;
+  if ((end-start<2) || (*start!='[') || (end[-1]!=']')) return -1;
+  start++; end--;
+  const char *first = start;
+  while ((first<end) && is_space_(*first)) first++;
+  if (first==end) return 0;
+
+  if (threads>JSON_SPLIT_MAX_THREADS) threads = JSON_SPLIT_MAX_THREADS;
+  if ((size_t)threads > (size_t)(end-start) / min_chunk) threads = (end-start) / min_chunk;
+  if (threads<1) threads = 1;
+  const char *bounds[JSON_SPLIT_MAX_THREADS+1];
+  json_split_state states[JSON_SPLIT_MAX_THREADS];
+  int quotes[JSON_SPLIT_MAX_THREADS];
+  long delta[2*JSON_SPLIT_MAX_THREADS];
+  json_split_worker workers[JSON_SPLIT_MAX_THREADS];
+  pthread_t tids[JSON_SPLIT_MAX_THREADS];
+
+  memset(&job, 0, sizeof(job));
+  job.json = json;
+  job.start = start;
+  job.end = end;
+  job.chunks = threads;
+  job.bounds = bounds;
+  job.states = states;
+  job.quotes = quotes;
+  job.delta = delta;
+  job.fn = fn;
+  job.ctx = ctx;
+  for (i=0; i<=threads; i++) bounds[i] = start + (end-start) / threads * i;
+  bounds[threads] = end;
+
+  json_split_pass(&job, workers, tids, 1);
+  for (i=0; i<threads; i++) {
+    const char *back = bounds[i];
+    while ((back>start) && is_escape_(back[-1])) back--;
+    states[i].in_string = in_string;
+    states[i].escaped = (bounds[i]-back) & 1;
+    states[i].depth = depth;
+    depth += delta[2*i + in_string];
+    if (depth<0) return -1;
+    in_string ^= quotes[i];
+  }
+  if (depth || in_string) return -1;
+
+  json_split_pass(&job, workers, tids, 2);
+  for (i=0; i<threads; i++) count += workers[i].count;
+  return (job.error) ? -1 : count;
+}
+
+// hands each element of the top level array in json to fn, from up to
+// threads (at most 64) threads at once and in no particular order. returns
+// the number of elements, -1 if json is not a balanced array or has an
+// empty element.
+// when fn returns 0 the split stops early
+long jsonSplitArray(const char *json, size_t len, int threads, jsonElementFn fn, void *ctx) {
+  return json_split_array(json, len, threads, JSON_SPLIT_MIN_CHUNK, fn, ctx);
+}
+#endif
+
+// ---- push parser ----
+// events for every value of documents fed in chunks split anywhere, with a
+// fixed size state. tokens inside one chunk are handed over in place; ones
+// that span chunks go through the state's buffer, long strings in pieces.
+// checks the grammar, escapes and control bytes, not \u digits or UTF-8.
+
+#define JSON_S_COLON 3 // after a member name
+#define JSON_S_FIRST 4 // after '{' or '[': first member or closing bracket
+#define JSON_S_WORD  JSON_EVENT_TRUE // token: true, false or null, told apart at its end
+
+void jsonSaxInit(jsonSax *sax, jsonEventFn fn, void *ctx) {
+  memset(sax, 0, sizeof(*sax));
+  sax->fn = fn;
+  sax->ctx = ctx;
+  sax->state = JSON_V_VALUE;
+}
+
+static int json_sax_event(jsonSax *sax, jsonEventType type, const char *data, size_t len, int partial) {
+  jsonEvent event;
+  event.type = type;
+  event.data = data;
+  event.len = len;
+  event.depth = sax->depth;
+  event.partial = partial;
+  if (sax->fn(sax->ctx, &event)) return 1;
+  sax->error = -1;
+  return 0;
+}
+
+static const char *json_sax_fail(jsonSax *sax, const char *chunk, const char *p) {
+  if (sax->error==-1) return NULL; // fn stopped, not an error in the input
+  sax->error = 1;
+  sax->error_offset = sax->offset + (p - chunk);
+  return NULL;
+}
+
+// broken or too long token: the error is at its start
+static const char *json_sax_fail_token(jsonSax *sax) {
+  if (sax->error==-1) return NULL;
+  if (!sax->error) sax->error = 1;
+  sax->error_offset = sax->token_offset;
+  return NULL;
+}
+
+// open containers, a bit each: 1 = object
+static int json_sax_in_object(const jsonSax *sax) {
+  return (sax->stack[(sax->depth-1) >> 3] >> ((sax->depth-1) & 7)) & 1;
+}
+
+// part of the current token to the buffer; a full buffer goes out as a
+// partial string, a number may not get that long and a word cannot
+static int json_sax_append(jsonSax *sax, const char *data, size_t len) {
+  while (len) {
+    if (sax->buf_len==sizeof(sax->buf)) {
+      if ((sax->token!=JSON_EVENT_KEY) && (sax->token!=JSON_EVENT_STRING)) {
+        sax->error = (sax->token==JSON_EVENT_NUMBER) ? 2 : 1;
+        return 0;
+      }
+      if (!json_sax_event(sax, sax->token, sax->buf, sax->buf_len, 1)) return 0;
+      sax->buf_len = 0;
+    }
+    size_t n = sizeof(sax->buf) - sax->buf_len;
+    if (n>len) n = len;
+    memcpy(sax->buf + sax->buf_len, data, n);
+    sax->buf_len += n;
+    data += n;
+    len -= n;
+  }
+  return 1;
+}
+
+// emit the finished token: data in place, or the buffer plus data
+static int json_sax_token_end(jsonSax *sax, jsonEventType type, const char *data, size_t len) {
+  if (sax->buf_len) {
+    if (!json_sax_append(sax, data, len)) return 0;
+    data = sax->buf;
+    len = sax->buf_len;
+    sax->buf_len = 0;
+  }
+  sax->token = 0;
+  if (type==JSON_EVENT_NUMBER) {
+    if (len>JSON_SAX_BUFFER) { sax->error = 2; return 0; } // the same in place as across chunks
+    if (json_validate_number(data, data+len)!=data+len) { sax->error = 1; return 0; }
+  } else if (type==JSON_S_WORD) {
+    jsonType word = json_word_type(data, len);
+    if (word==JSON_NONE) { sax->error = 1; return 0; }
+    type = (word==JSON_TRUE) ? JSON_EVENT_TRUE : (word==JSON_FALSE) ? JSON_EVENT_FALSE : JSON_EVENT_NULL;
+  }
+  sax->state = (type==JSON_EVENT_KEY) ? JSON_S_COLON : JSON_V_AFTER;
+  return json_sax_event(sax, type, data, len, 0);
+}
+
+// string contents from p; past the closing quote, end if it continues in
+// the next chunk, NULL on error
+static const char *json_sax_string(jsonSax *sax, const char *chunk, const char *p, const char *end) {
+  const char *start = p;
+  while (p<end) {
+    if (sax->escaped) {
+      if (!json_unescape_table[(unsigned char)*p] && (*p!='u')) return json_sax_fail(sax, chunk, p);
+      sax->escaped = 0;
+      p++;
+      continue;
+    }
+    // most strings are short: look at a few bytes before classifying blocks
+    const int classes = JSON_SCAN_QUOTE | JSON_SCAN_ESCAPE | JSON_SCAN_CONTROL;
+    const char *near = (end-p > 16) ? p + 16 : end;
+    while ((p<near) && !(json_class_(*p) & classes)) p++;
+    if (p==near) p = json_scan(p, end, classes);
+    if (p>=end) break;
+    if (is_escape_(*p)) { sax->escaped = 1; p++; continue; }
+    if (!is_doublequote_(*p)) return json_sax_fail(sax, chunk, p); // control byte
+    if (!json_sax_token_end(sax, sax->token, start, p-start)) return json_sax_fail_token(sax);
+    return p+1;
+  }
+  if (!json_sax_append(sax, start, p-start)) return json_sax_fail_token(sax);
+  return end;
+}
+
+// number or word from p, ends at the first byte that cannot be part of it
+static const char *json_sax_scalar(jsonSax *sax, const char *p, const char *end) {
+  const char *start = p;
+  if (sax->token==JSON_EVENT_NUMBER) {
+    while ((p<end) && (is_number_(*p) || (*p=='-') || (*p=='+') || (*p=='.') || (*p=='e') || (*p=='E'))) p++;
+  } else {
+    while ((p<end) && is_lower_(*p)) p++;
+  }
+  if (p>=end) {
+    if (!json_sax_append(sax, start, p-start)) return json_sax_fail_token(sax);
+    return end;
+  }
+  if (!json_sax_token_end(sax, sax->token, start, p-start)) return json_sax_fail_token(sax);
+  return p;
+}
+
+// feed one chunk; returns 1, or 0 on invalid JSON (error 1, or 2 for a
+// number over JSON_SAX_BUFFER; error_offset from the start of the input)
+// or when fn stopped (error -1)
+int jsonSaxWrite(jsonSax *sax, const char *chunk, size_t len) {
+  const char *p = chunk, *end = chunk + len;
+
+  while (!sax->error) {
+    if (sax->token) { // continue the token the last chunk ended in
+      if ((sax->token==JSON_EVENT_KEY) || (sax->token==JSON_EVENT_STRING)) p = json_sax_string(sax, chunk, p, end);
+      else p = json_sax_scalar(sax, p, end);
+      if (!p || (p>=end)) break;
+      continue;
+    }
+    while ((p<end) && is_space_(*p)) p++;
+    if (p>=end) break;
+
+    char ch = *p;
+    switch (sax->state) {
+    case JSON_S_FIRST:
+    case JSON_V_AFTER:
+      if (!sax->depth) { sax->state = JSON_V_VALUE; continue; } // next document
+      if (ch==(json_sax_in_object(sax) ? '}' : ']')) {
+        sax->depth--;
+        sax->state = JSON_V_AFTER;
+        if (!json_sax_event(sax, (ch=='}') ? JSON_EVENT_OBJECT_END : JSON_EVENT_ARRAY_END, p, 1, 0)) break;
+        p++;
+      } else if (sax->state==JSON_S_FIRST) {
+        sax->state = (json_sax_in_object(sax)) ? JSON_V_KEY : JSON_V_VALUE;
+      } else if (ch==',') {
+        sax->state = (json_sax_in_object(sax)) ? JSON_V_KEY : JSON_V_VALUE;
+        p++;
+      } else json_sax_fail(sax, chunk, p);
+      break;
+
+    case JSON_S_COLON:
+      if (ch==':') { sax->state = JSON_V_VALUE; p++; }
+      else json_sax_fail(sax, chunk, p);
+      break;
+
+    case JSON_V_KEY:
+      sax->token_offset = sax->offset + (p - chunk);
+      if (is_doublequote_(ch)) { sax->token = JSON_EVENT_KEY; p++; }
+      else json_sax_fail(sax, chunk, p);
+      break;
+
+    default: // a value
+      sax->token_offset = sax->offset + (p - chunk);
+      if ((ch=='{') || (ch=='[')) {
+        if (sax->depth>=JSON_VALIDATE_MAX_DEPTH) { json_sax_fail(sax, chunk, p); break; }
+        if (!json_sax_event(sax, (ch=='{') ? JSON_EVENT_OBJECT_START : JSON_EVENT_ARRAY_START, p, 1, 0)) break;
+        if (ch=='{') sax->stack[sax->depth >> 3] |= 1 << (sax->depth & 7);
+        else sax->stack[sax->depth >> 3] &= ~(1 << (sax->depth & 7));
+        sax->depth++;
+        sax->state = JSON_S_FIRST;
+        p++;
+      } else if (is_doublequote_(ch)) { sax->token = JSON_EVENT_STRING; p++; }
+      else if ((ch=='-') || is_number_(ch)) sax->token = JSON_EVENT_NUMBER;
+      else if (is_lower_(ch)) sax->token = JSON_S_WORD;
+      else json_sax_fail(sax, chunk, p);
+    }
+  }
+  sax->offset += len;
+  return !sax->error;
+}
+
+// end of input: finishes a number or word at the very end. returns 1 if
+// the input was complete JSON (one or more documents)
+int jsonSaxEnd(jsonSax *sax) {
+  if (!sax->error && sax->token && (sax->token!=JSON_EVENT_KEY) && (sax->token!=JSON_EVENT_STRING)) {
+    if (!json_sax_token_end(sax, sax->token, "", 0)) json_sax_fail_token(sax);
+  }
+  if (!sax->error && (sax->token || sax->depth || (sax->state!=JSON_V_AFTER))) {
+    sax->error = 1;
+    sax->error_offset = sax->offset;
+  }
+  return !sax->error;
+}
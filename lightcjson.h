@@ -23,6 +23,9 @@
 #ifndef LIGHTCJSON_H
 #define LIGHTCJSON_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 // just trim beginning / trailing unnecessary spaces
 char *jsonTrim(const char *src, char *dest);
 
@@ -50,4 +53,349 @@ int jsonGetKeyValue(const char *input, char *key, char *value, int item_size);
 int jsonStreamKeyValues(const char *new_input, char *buffer, int max_buffer, 
     int start_offset, int *last_offset);
 
-#endif
\ No newline at end of file
+// value types
+typedef enum {
+  JSON_NONE = 0,
+  JSON_OBJECT,
+  JSON_ARRAY,
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_TRUE,
+  JSON_FALSE,
+  JSON_NULL
+} jsonType;
+
+// one entry of the token tape
+typedef struct {
+  int offset;     // start of token in json
+  int len;        // length of token, structs/lists include closing bracket
+  int depth;      // nesting level, 0 = outermost
+  int next;       // index of first token after this one and its children
+  int is_key;     // string followed by ':'
+  jsonType type;
+} jsonToken;
+
+// index all tokens of a JSON string in one pass, no allocation.
+// returns count, -1 when tokens run out or json is over INT_MAX bytes
+int jsonTokenize(const char *json, jsonToken *tokens, int max_tokens);
+
+// token lookups: key value within parent (-1 = anywhere), n-th child
+int jsonTokenFind(const char *json, const jsonToken *tokens, int count, 
+    int parent, const char *key_name);
+int jsonTokenChild(const jsonToken *tokens, int count, int parent, int index);
+char *jsonTokenCopy(const char *json, const jsonToken *token, char *dest, int size);
+
+// jsonExtract / jsonIndexList / jsonGetKeyValue on a token tape
+char *jsonTokenExtract(const char *json, const jsonToken *tokens, int count, 
+    const char *name, char *dest, int size);
+char *jsonTokenIndexList(const char *json, const jsonToken *tokens, int count, 
+    int index, char *dest, int size);
+int jsonTokenGetKeyValue(const char *json, const jsonToken *tokens, int count, 
+    int key_token, char *key, char *value, int item_size);
+
+// JSON builder writing into a fixed caller buffer
+#define JSON_BUILD_MAX_DEPTH 64
+typedef struct {
+  char *dest;
+  int size;
+  int len;          // bytes written so far, dest[len] is '\0'
+  int depth;
+  uint64_t lists;   // bit n set: level n is a list
+  int error;        // set on overflow or misuse, later calls do nothing
+} jsonBuilder;
+
+// key is NULL for list items and top level values; all return 1=ok, 0=error
+void jsonBuildInit(jsonBuilder *builder, char *dest, int size);
+int jsonBuildObject(jsonBuilder *builder, const char *key);
+int jsonBuildArray(jsonBuilder *builder, const char *key);
+int jsonBuildEnd(jsonBuilder *builder);
+int jsonBuildString(jsonBuilder *builder, const char *key, const char *value);
+int jsonBuildInt(jsonBuilder *builder, const char *key, int64_t value);
+int jsonBuildDouble(jsonBuilder *builder, const char *key, double value);
+int jsonBuildBool(jsonBuilder *builder, const char *key, int value);
+int jsonBuildNull(jsonBuilder *builder, const char *key);
+int jsonBuildRaw(jsonBuilder *builder, const char *key, const char *json);
+
+// pointer+length variants: input does not need a '\0' terminator and is
+// never read past len. output in dest is '\0' terminated.
+char *jsonTrimN(const char *src, size_t len, char *dest);
+char *jsonRemoveSpacingN(const char *json, size_t len, char *dest);
+char *jsonIndexListN(const char *json, size_t len, int index, char *dest, int size);
+char *jsonExtractN(const char *json, size_t len, const char *name, char *dest, int size);
+char *jsonEscapeN(const char *input, size_t len, char *dest, int size);
+int jsonEscapeTo(const char *input, size_t len, char *dest, int size);
+char *jsonUnescapeN(const char *json, size_t len, char *dest, int size);
+int jsonTokenizeN(const char *json, size_t len, jsonToken *tokens, int max_tokens);
+
+// zero-copy results: a view of a value inside the input
+typedef struct {
+  size_t offset;    // start of value in input
+  size_t len;
+  jsonType type;
+} jsonSpan;
+
+int jsonExtractSpan(const char *json, size_t len, const char *name, jsonSpan *span);
+int jsonIndexListSpan(const char *json, size_t len, int index, jsonSpan *span);
+char *jsonSpanCopy(const char *json, const jsonSpan *span, char *dest, int size);
+
+// look up count keys in a single pass, returns -1 for more than
+// JSON_MANY_MAX_KEYS keys
+#define JSON_MANY_MAX_KEYS 64
+int jsonExtractMany(const char *json, size_t len, const char **keys, 
+    jsonSpan *spans, int count);
+
+// cursors: walk the members of a list or object in one pass
+// with walk set (after Init, kept by jsonCursorEnter) list and object
+// members are returned open, their span running to the end of the input:
+// walked by jsonCursorEnter, or else skipped by the next call, each byte is
+// scanned once
+typedef struct jsonCursor {
+  const char *json; // document, spans are relative to it
+  size_t pos;       // next member
+  size_t end;       // end of input
+  int depth;        // nesting depth of the container, 1 = top level
+  int count;        // members returned so far
+  int walk;         // return list and object members open
+  int open;         // 1 = pos is at an open member, 2 = just past it
+  struct jsonCursor *parent; // entered from, resumes where this one ends
+} jsonCursor;
+
+int jsonListInit(jsonCursor *cursor, const char *json, size_t len);
+int jsonListNext(jsonCursor *cursor, jsonSpan *span);
+char *jsonListNextItem(jsonCursor *cursor, char *dest, int size);
+int jsonObjectInit(jsonCursor *cursor, const char *json, size_t len);
+int jsonObjectNext(jsonCursor *cursor, jsonSpan *key, jsonSpan *value);
+int jsonCursorEnter(jsonCursor *cursor, const jsonSpan *value, jsonCursor *child);
+
+// path queries: "a.b[3].c" or JSON Pointer "/a/b/3/c"; dotted keys may not
+// be empty, "" is only reached by a pointer ("/")
+int jsonQuerySpan(const char *json, size_t len, const char *path, jsonSpan *span);
+char *jsonQuery(const char *json, const char *path, char *dest, int size);
+
+// typed values: numbers are decoded without a strtod round-trip
+typedef struct {
+  jsonType type;
+  int is_int;           // number is an integer that fits int64_t
+  int64_t int_value;
+  double double_value;  // any number, correctly rounded
+  int bool_value;
+  jsonSpan span;        // raw text of the value
+} jsonValue;
+
+int jsonParseInt64(const char *ptr, size_t len, int64_t *out);
+int jsonParseDouble(const char *ptr, size_t len, double *out);
+jsonType jsonDecodeValue(const char *json, const jsonSpan *span, jsonValue *value);
+jsonType jsonExtractValue(const char *json, size_t len, const char *name, jsonValue *value);
+int jsonExtractInt64(const char *json, const char *name, int64_t *out);
+int jsonExtractDouble(const char *json, const char *name, double *out);
+int jsonExtractBool(const char *json, const char *name, int *out);
+
+// schema binding: decode a flat struct straight into C struct fields
+typedef enum {
+  JSON_FIELD_INT = 0,   // int
+  JSON_FIELD_INT64,     // int64_t
+  JSON_FIELD_DOUBLE,    // double
+  JSON_FIELD_BOOL,      // int, 0 or 1
+  JSON_FIELD_STRING     // char[], unescaped and '\0' terminated
+} jsonFieldType;
+
+typedef struct {
+  const char *name;
+  jsonFieldType type;
+  size_t offset;        // offsetof() the member
+  size_t size;          // sizeof() the member
+} jsonField;
+
+// field named like the member, or with its own JSON name
+#define JSON_FIELD(struct_type, member, field_type) \
+  { #member, field_type, offsetof(struct_type, member), sizeof(((struct_type *)0)->member) }
+#define JSON_FIELD_NAMED(name, struct_type, member, field_type) \
+  { name, field_type, offsetof(struct_type, member), sizeof(((struct_type *)0)->member) }
+
+// perfect hash from key name to field
+#define JSON_SCHEMA_MAX_FIELDS 64
+#define JSON_SCHEMA_SLOTS 256
+typedef struct {
+  const jsonField *fields;
+  int count;
+  uint32_t seed;
+  uint32_t mask;
+  unsigned char name_len[JSON_SCHEMA_MAX_FIELDS];
+  unsigned char slots[JSON_SCHEMA_SLOTS]; // field index+1, 0 = no field
+} jsonSchema;
+
+int jsonSchemaCompile(jsonSchema *schema, const jsonField *fields, int count);
+int jsonSchemaDecode(const jsonSchema *schema, const char *json, size_t len, void *out);
+
+// resumable key/value stream parser over a ring buffer (caller storage)
+typedef struct {
+  char *buffer;
+  size_t size;
+  size_t start;       // first byte still needed
+  size_t pos;         // next byte to parse
+  size_t end;         // bytes fed so far
+  size_t key_start, key_end, value_start;
+  int state;
+} jsonStream;
+
+void jsonStreamInit(jsonStream *stream, char *buffer, size_t size);
+size_t jsonStreamFeed(jsonStream *stream, const char *data, size_t len);
+int jsonStreamNext(jsonStream *stream, char *key, char *value, int item_size);
+
+// ---- hot-path counters ----
+// counts of the calling thread since its last jsonStatsReset(). only built
+// with -DLIGHTCJSON_STATS (make STATS=1), otherwise the snapshot is all 0.
+typedef struct {
+  uint64_t bytes_scanned;   // bytes run through the structural scanner
+  uint64_t strlen_calls;    // strlen() on '\0' terminated input
+  uint64_t key_searches;    // memmem/strstr style searches for a key name
+  uint64_t bytes_copied;    // bytes written into dest buffers
+  uint64_t buffer_shifts;   // jsonStreamKeyValues buffer shifts
+  uint64_t shift_bytes;     // bytes moved by those shifts
+  uint64_t stream_restarts; // jsonStreamKeyValues restarts on broken json
+  uint64_t overfills;       // calls failing for lack of room (-1 / builder error)
+} jsonStats;
+
+void jsonStatsSnapshot(jsonStats *stats);
+void jsonStatsReset(void);
+
+// validation: full grammar, bracket balance and UTF-8 in one pass
+#define JSON_VALIDATE_MAX_DEPTH 1024
+int jsonValidate(const char *json, size_t len, size_t *err_offset);
+
+// lookups for input that passed jsonValidate, skipping checks for broken JSON.
+// jsonExtractSpanTrusted finds a member like jsonExtractMany (never a string
+// value that equals the name), jsonExtractSpan may return such a string
+int jsonExtractSpanTrusted(const char *json, size_t len, const char *name, jsonSpan *span);
+int jsonIndexListSpanTrusted(const char *json, size_t len, int index, jsonSpan *span);
+
+// DOM in a caller supplied arena: one parse, no malloc, freed as a whole.
+// children of a container follow it in nodes[], siblings are linked by index
+typedef struct {
+  jsonType type;
+  int count;          // members of an object or array
+  int next;           // index of the next sibling, -1 = last
+  const char *key;    // object member name, unescaped, NULL otherwise
+  size_t key_len;
+  const char *value;  // string unescaped, number as written, '\0' terminated
+  size_t len;         // length of value
+} jsonNode;
+
+typedef struct {
+  char *arena;
+  size_t size;
+  jsonNode *nodes;    // nodes[0..count) from the front of the arena
+  int count;
+  size_t top;         // strings use arena[top..size)
+  int error;          // last parse: 1 = invalid JSON, -1 = arena full
+  size_t error_offset;
+} jsonDom;
+
+void jsonDomInit(jsonDom *dom, void *arena, size_t size);
+void jsonDomReset(jsonDom *dom);
+const jsonNode *jsonDomParse(jsonDom *dom, const char *json, size_t len);
+const jsonNode *jsonDomChild(const jsonNode *node);
+const jsonNode *jsonDomNext(const jsonDom *dom, const jsonNode *node);
+const jsonNode *jsonDomGet(const jsonDom *dom, const jsonNode *object, const char *key);
+const jsonNode *jsonDomIndex(const jsonDom *dom, const jsonNode *node, int index);
+
+// binary form with offset tables: lookups by key (binary search) or index
+// without scanning. spans point into the binary; strings are unescaped
+long jsonBinEncode(const char *json, size_t len, char *dest, size_t size);
+long jsonBinDecode(const char *bin, const jsonSpan *span, char *dest, size_t size);
+int jsonBinRoot(const char *bin, size_t len, jsonSpan *span);
+int jsonBinCount(const char *bin, const jsonSpan *span);
+int jsonBinGet(const char *bin, const jsonSpan *object, const char *name, jsonSpan *value);
+int jsonBinIndex(const char *bin, const jsonSpan *list, int index, jsonSpan *item);
+int jsonBinMember(const char *bin, const jsonSpan *object, int index, 
+    jsonSpan *key, jsonSpan *value);
+jsonType jsonBinValue(const char *bin, const jsonSpan *span, jsonValue *value);
+
+// streaming minifier: feed a document in chunks split anywhere, memory
+// stays constant. write returns 1 = ok, 0 = stop
+typedef int (*jsonWriteFn)(void *ctx, const char *data, size_t len);
+
+typedef struct {
+  int in_string;      // last chunk ended inside a string
+  int escaped;        // ... and with an escaping backslash
+  jsonWriteFn write;  // output of jsonMinifyWrite
+  void *ctx;
+  int error;          // write failed, later calls do nothing
+} jsonMinify;
+
+void jsonMinifyInit(jsonMinify *minify, jsonWriteFn write, void *ctx);
+size_t jsonMinifyChunk(jsonMinify *minify, const char *chunk, size_t len, char *dest);
+int jsonMinifyWrite(jsonMinify *minify, const char *chunk, size_t len);
+int jsonMinifyEnd(const jsonMinify *minify);
+
+// key projection: keep (or with deny, drop) the named members of each root
+// object, copying values verbatim. chunks split anywhere, constant memory.
+// names longer than JSON_PROJECT_NAME_MAX never match
+#define JSON_PROJECT_NAME_MAX 256
+
+typedef struct {
+  const char **keys;
+  int key_count;
+  int deny;           // 1: keys lists the members to drop
+  jsonWriteFn write;
+  void *ctx;
+  int error;          // 1 = invalid JSON, -1 = write failed
+  // parse state carried between chunks
+  int state, member, first, depth, in_string, escaped, decided, keep;
+  char name[JSON_PROJECT_NAME_MAX];
+  size_t name_len;
+} jsonProject;
+
+void jsonProjectInit(jsonProject *project, const char **keys, int key_count,
+    int deny, jsonWriteFn write, void *ctx);
+int jsonProjectWrite(jsonProject *project, const char *chunk, size_t len);
+int jsonProjectEnd(const jsonProject *project);
+
+#ifndef JSON_NO_THREADS
+// parallel split of one large top level array: fn gets every element, from
+// several threads at once and in no particular order. fn returns 0 to stop
+typedef int (*jsonElementFn)(void *ctx, const char *json, const jsonSpan *span);
+
+long jsonSplitArray(const char *json, size_t len, int threads, jsonElementFn fn, void *ctx);
+#endif
+
+// push parser: events for every value of documents fed in chunks split
+// anywhere. strings (escaped, without quotes) that span chunks and are
+// longer than JSON_SAX_BUFFER come in pieces with partial set; numbers
+// longer than that are an error (2), however they are split
+#define JSON_SAX_BUFFER 256
+
+typedef enum {
+  JSON_EVENT_OBJECT_START = 1, JSON_EVENT_OBJECT_END, JSON_EVENT_ARRAY_START, JSON_EVENT_ARRAY_END,
+  JSON_EVENT_KEY, JSON_EVENT_STRING, JSON_EVENT_NUMBER, JSON_EVENT_TRUE, JSON_EVENT_FALSE, JSON_EVENT_NULL
+} jsonEventType;
+
+typedef struct {
+  jsonEventType type;
+  const char *data;   // text of the token, valid during the callback only
+  size_t len;
+  int depth;          // containers around it; a container's start and end are outside it
+  int partial;        // more of this key/string follows in the next event
+} jsonEvent;
+
+typedef int (*jsonEventFn)(void *ctx, const jsonEvent *event); // 0 = stop
+
+typedef struct {
+  jsonEventFn fn;
+  void *ctx;
+  int error;          // 1 = invalid JSON, 2 = number too long, -1 = fn stopped
+  size_t error_offset;
+  // parse state carried between chunks
+  int state, depth, token, escaped;
+  size_t offset;      // bytes fed before this chunk
+  size_t token_offset;
+  unsigned char stack[JSON_VALIDATE_MAX_DEPTH / 8];
+  size_t buf_len;
+  char buf[JSON_SAX_BUFFER];
+} jsonSax;
+
+void jsonSaxInit(jsonSax *sax, jsonEventFn fn, void *ctx);
+int jsonSaxWrite(jsonSax *sax, const char *chunk, size_t len);
+int jsonSaxEnd(jsonSax *sax);
+
+#endif
@@ -0,0 +1,138 @@
+/*
+  Copyright (c) 2022-2022 John Mueller and LightCJSON contributors
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* lightcjson_epoll.c */
+/* epoll driver over jsonSax: every connection keeps only its parser state,
+   reads go through one buffer shared by the loop and are parsed at once. */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include "lightcjson_epoll.h"
+
+int jsonLoopInit(jsonLoop *loop, jsonConnEventFn on_event, jsonConnCloseFn on_close) {
+  loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+  loop->count = 0;
+  loop->on_event = on_event;
+  loop->on_close = on_close;
+  loop->running = 0;
+  loop->closed = NULL;
+  return (loop->epfd>=0);
+}
+
+// keys are held back until their value, which gets them in conn->key
+static int json_conn_event(void *ctx, const jsonEvent *event) {
+  jsonConn *conn = ctx;
+  if (conn->fd<0) return 0; // closed by on_event: no more of this read
+  if (event->type==JSON_EVENT_KEY) {
+    size_t len = event->len;
+    if (conn->keyed!=1) conn->key_len = 0; // a new name, not its next piece
+    if (len > sizeof(conn->key)-1 - conn->key_len) len = sizeof(conn->key)-1 - conn->key_len;
+    memcpy(conn->key + conn->key_len, event->data, len);
+    conn->key_len += len;
+    conn->key[conn->key_len] = '\0';
+    conn->keyed = (event->partial) ? 1 : 2;
+    return 1;
+  }
+  int ok = conn->loop->on_event(conn, event);
+  if (!event->partial) { // the key was used up
+    conn->keyed = 0;
+    conn->key_len = 0;
+    conn->key[0] = '\0';
+  }
+  return ok;
+}
+
+// conn in caller memory, fd is made non-blocking and owned by the loop
+int jsonLoopAdd(jsonLoop *loop, jsonConn *conn, int fd, void *user) {
+  struct epoll_event ev;
+  int flags = fcntl(fd, F_GETFL);
+  if ((flags<0) || (fcntl(fd, F_SETFL, flags | O_NONBLOCK)<0)) return 0;
+  memset(conn, 0, sizeof(*conn));
+  conn->fd = fd;
+  conn->user = user;
+  conn->loop = loop;
+  jsonSaxInit(&conn->sax, json_conn_event, conn);
+  ev.events = EPOLLIN;
+  ev.data.ptr = conn;
+  if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, fd, &ev)<0) return 0;
+  loop->count++;
+  return 1;
+}
+
+// remove conn, close its fd and tell on_close: at once, or after the batch
+// when called from within jsonLoopRun, as later events of the batch may
+// still point to conn
+void jsonLoopClose(jsonConn *conn, int error) {
+  jsonLoop *loop = conn->loop;
+  if (conn->fd<0) return;
+  epoll_ctl(loop->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+  close(conn->fd);
+  conn->fd = -1;
+  loop->count--;
+  if (loop->running) {
+    conn->error = error;
+    conn->next_closed = loop->closed;
+    loop->closed = conn;
+  } else if (loop->on_close) loop->on_close(conn, error);
+}
+
+// one read of a ready connection, parsed at once
+static void json_loop_read(jsonLoop *loop, jsonConn *conn) {
+  ssize_t n = read(conn->fd, loop->buf, sizeof(loop->buf));
+  if (n>0) {
+    if (!jsonSaxWrite(&conn->sax, loop->buf, n)) {
+      jsonLoopClose(conn, (conn->sax.error==-1) ? -2 : 1);
+    }
+  } else if (n==0) { // end of input: fine between documents
+    int complete = (conn->sax.offset==0) || jsonSaxEnd(&conn->sax);
+    jsonLoopClose(conn, (complete) ? 0 : 1);
+  } else if ((errno!=EAGAIN) && (errno!=EWOULDBLOCK) && (errno!=EINTR)) {
+    jsonLoopClose(conn, -1);
+  }
+}
+
+// wait up to timeout_ms (-1 = no limit) and serve ready connections, one
+// read each. returns connections served, -1 on an epoll error
+int jsonLoopRun(jsonLoop *loop, int timeout_ms) {
+  struct epoll_event events[JSON_LOOP_EVENTS];
+  int n = epoll_wait(loop->epfd, events, JSON_LOOP_EVENTS, timeout_ms), i;
+  if (n<0) return (errno==EINTR) ? 0 : -1;
+  loop->running = 1;
+  for (i=0; i<n; i++) {
+    jsonConn *conn = events[i].data.ptr;
+    if (conn->fd<0) continue; // closed earlier in this round
+    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) json_loop_read(loop, conn);
+  }
+  loop->running = 0;
+  while (loop->closed) { // nothing points to these any more
+    jsonConn *conn = loop->closed;
+    loop->closed = conn->next_closed;
+    if (loop->on_close) loop->on_close(conn, conn->error);
+  }
+  return n;
+}
+
+// connections still open are left to the caller
+void jsonLoopFree(jsonLoop *loop) {
+  close(loop->epfd);
+  loop->epfd = -1;
+}
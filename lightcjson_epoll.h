@@ -0,0 +1,73 @@
+/*
+  Copyright (c) 2022-2022 John Mueller and LightCJSON contributors
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* lightcjson_epoll.h */
+/* epoll driver: many non-blocking connections that each trickle JSON. */
+
+#ifndef LIGHTCJSON_EPOLL_H
+#define LIGHTCJSON_EPOLL_H
+
+#include "lightcjson.h"
+
+#define JSON_CONN_KEY_MAX 64    // member names are cut to this for on_event
+#define JSON_LOOP_READ (1 << 16) // one read buffer shared by all connections
+#define JSON_LOOP_EVENTS 256    // ready fds taken per epoll_wait
+
+typedef struct jsonLoop jsonLoop;
+
+// per connection state in caller memory, fixed size
+typedef struct jsonConn {
+  int fd;
+  void *user;
+  jsonLoop *loop;
+  jsonSax sax;
+  char key[JSON_CONN_KEY_MAX]; // name of the member the event is the value of, else ""
+  size_t key_len;
+  int keyed;                   // 1 = name still coming in pieces, 2 = for the next value
+  int error;                   // closed in a batch: error for on_close after it
+  struct jsonConn *next_closed;
+} jsonConn;
+
+// an event of conn: keys are not passed on, they are in conn->key for the
+// value that follows. return 0 to close the connection
+typedef int (*jsonConnEventFn)(jsonConn *conn, const jsonEvent *event);
+
+// conn was closed and removed: error 0 = end of input after whole documents,
+// 1 = invalid JSON (conn->sax.error_offset), -1 = read error, -2 = on_event.
+// within jsonLoopRun it is called after the batch of ready fds, so conn may
+// be freed here
+typedef void (*jsonConnCloseFn)(jsonConn *conn, int error);
+
+struct jsonLoop {
+  int epfd;
+  int count;                   // connections added
+  jsonConnEventFn on_event;
+  jsonConnCloseFn on_close;
+  int running;                 // inside jsonLoopRun
+  jsonConn *closed;            // closed in this batch, on_close still to call
+  char buf[JSON_LOOP_READ];
+};
+
+int jsonLoopInit(jsonLoop *loop, jsonConnEventFn on_event, jsonConnCloseFn on_close);
+int jsonLoopAdd(jsonLoop *loop, jsonConn *conn, int fd, void *user);
+void jsonLoopClose(jsonConn *conn, int error);
+int jsonLoopRun(jsonLoop *loop, int timeout_ms);
+void jsonLoopFree(jsonLoop *loop);
+
+#endif
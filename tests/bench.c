@@ -0,0 +1,696 @@
+/* bench.c  */
+/* Benchmarks over deterministic synthetic corpora.
+
+   usage: tests/bench.o [-t ms] [filter]
+
+   Every benchmark runs for about ms milliseconds (default 200) in
+   timed batches. Output is tab separated, one line per benchmark:
+   name, corpus, bytes per op, ops, ns/op, MB/s and the 50/90/99th
+   percentile ns/op over the batches. Corpora come from a fixed seed, so
+   numbers are comparable between runs and builds.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <time.h>
+#include "lightcjson.h"
+
+#define MAX_SAMPLES 2000
+#define SAMPLE_NS 20000 // a timed batch lasts at least this long
+
+typedef struct {
+    const char *name;
+    char *json;
+    size_t len;
+} corpus;
+
+static corpus flat, deep, escaped, numbers, ndjson, array;
+static char *numbers_body;          // numbers without the brackets
+static size_t numbers_body_len;
+static char *raw_text;              // unescaped text of escaped's first string
+static size_t raw_len;
+static char *quoted_text;
+static char deep_path[1024];
+static jsonToken *flat_tokens, *numbers_tokens;
+static int flat_token_count, numbers_token_count;
+static char *out;                   // shared output buffer
+static size_t out_size;
+static volatile long sink;          // keeps results alive
+static int chunk_size;              // for the stream benchmarks
+static int budget_ms = 200;
+static const char *filter;
+
+static uint64_t rnd_state;
+static uint64_t rnd(void) {
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 7;
+    rnd_state ^= rnd_state << 17;
+    return rnd_state;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+// ---- corpora ----
+
+typedef struct {
+    char *data;
+    size_t len, size;
+} strbuf;
+
+static void sb_printf(strbuf *sb, const char *fmt, ...) {
+    va_list ap;
+    while (1) {
+        va_start(ap, fmt);
+        int n = vsnprintf(sb->data + sb->len, sb->size - sb->len, fmt, ap);
+        va_end(ap);
+        if ((size_t)n < sb->size - sb->len) { sb->len += n; return; }
+        sb->size = (sb->size) ? sb->size*2 : 4096;
+        sb->data = realloc(sb->data, sb->size);
+    }
+}
+
+static corpus sb_corpus(const char *name, strbuf *sb) {
+    corpus c = { name, sb->data, sb->len };
+    return c;
+}
+
+// flat telemetry object, about 450 bytes
+static void gen_flat_object(strbuf *sb) {
+    sb_printf(sb, "{\"id\":%d, \"ts\":%llu, \"device\":\"dev-%04x\", \"temp\":%.3f, "
+        "\"humidity\":%.2f, \"pressure\":%d, \"ok\":%s, \"lat\":%.6f, \"lon\":%.6f, "
+        "\"fw\":\"%d.%d.%d\", \"rssi\":%d, \"battery\":%.1f, \"errors\":%d, "
+        "\"mode\":\"%s\", \"seq\":%d, \"uptime\":%d, \"tag\":null, "
+        "\"note\":\"reading \\\"%d\\\"\", \"v\":%.4e, \"last\":%d}",
+        (int)(rnd()%100000), 1700000000000ULL + rnd()%1000000000, (unsigned)(rnd()%65536),
+        (double)(rnd()%10000)/100 - 20, (double)(rnd()%10000)/100, (int)(rnd()%2000),
+        (rnd()&1) ? "true" : "false", (double)(rnd()%180000000)/1e6 - 90,
+        (double)(rnd()%360000000)/1e6 - 180, (int)(rnd()%10), (int)(rnd()%10), (int)(rnd()%100),
+        -(int)(rnd()%120), (double)(rnd()%1000)/10, (int)(rnd()%5),
+        (rnd()&1) ? "active" : "idle", (int)(rnd()%1000000), (int)(rnd()%10000000),
+        (int)(rnd()%100), (double)(rnd()%100000)/7, (int)(rnd()%100));
+}
+
+static void gen_corpora(void) {
+    strbuf sb;
+    int i, depth = 60;
+
+    rnd_state = 0x9E3779B97F4A7C15ULL;
+
+    memset(&sb, 0, sizeof(sb));
+    gen_flat_object(&sb);
+    flat = sb_corpus("flat", &sb);
+
+    // deep: {"n0":{"x":0,"l":[1,{"n1":{...}}]}} down to depth
+    memset(&sb, 0, sizeof(sb));
+    deep_path[0] = '\0';
+    for (i=0; i<depth; i++) {
+        sb_printf(&sb, "{\"n%d\":{\"x\":%d, \"s\":\"[{\\\"]}\", \"l\":[%d, ", i, i, i);
+        sprintf(deep_path + strlen(deep_path), "%sn%d.l[1]", (i) ? "." : "", i);
+    }
+    sb_printf(&sb, "{\"leaf\":true}");
+    strcat(deep_path, ".leaf");
+    for (i=0; i<depth; i++) sb_printf(&sb, "]}}");
+    deep = sb_corpus("deep", &sb);
+
+    // escaped: 16 strings of about 256 bytes, an escape every few bytes
+    memset(&sb, 0, sizeof(sb));
+    static const char *escapes[] = { "\\\"", "\\\\", "\\n", "\\t", "\\u00e9", "\\ud83d\\ude00", "\\/" };
+    sb_printf(&sb, "{");
+    for (i=0; i<16; i++) {
+        sb_printf(&sb, "%s\"s%d\":\"", (i) ? ", " : "", i);
+        int n = 0;
+        while (n<256) {
+            int run = rnd()%12;
+            for (int j=0; j<run; j++) sb_printf(&sb, "%c", 'a' + (int)(rnd()%26));
+            const char *esc = escapes[rnd()%7];
+            sb_printf(&sb, "%s", esc);
+            n += run + strlen(esc);
+        }
+        sb_printf(&sb, "\"");
+    }
+    sb_printf(&sb, "}");
+    escaped = sb_corpus("escaped", &sb);
+
+    // numbers: 10000 mixed integers and doubles
+    memset(&sb, 0, sizeof(sb));
+    sb_printf(&sb, "[");
+    for (i=0; i<10000; i++) {
+        const char *sep = (i) ? "," : "";
+        switch (rnd()%4) {
+        case 0: sb_printf(&sb, "%s%d", sep, (int)(rnd()%2000000) - 1000000); break;
+        case 1: sb_printf(&sb, "%s%lld", sep, (long long)(rnd()>>1)); break;
+        case 2: sb_printf(&sb, "%s%.*f", sep, (int)(rnd()%8), (double)(rnd()%100000000)/1000); break;
+        default: sb_printf(&sb, "%s%.17g", sep, (double)(rnd()>>11) * 1e-10); break;
+        }
+    }
+    sb_printf(&sb, "]");
+    numbers = sb_corpus("numbers", &sb);
+    numbers_body = numbers.json + 1;
+    numbers_body_len = numbers.len - 2;
+
+    // ndjson: 1000 flat objects, one per line
+    memset(&sb, 0, sizeof(sb));
+    for (i=0; i<1000; i++) {
+        gen_flat_object(&sb);
+        sb_printf(&sb, "\n");
+    }
+    ndjson = sb_corpus("ndjson", &sb);
+
+    // array: 8000 flat objects in one top level array
+    memset(&sb, 0, sizeof(sb));
+    sb_printf(&sb, "[");
+    for (i=0; i<8000; i++) {
+        if (i) sb_printf(&sb, ",\n");
+        gen_flat_object(&sb);
+    }
+    sb_printf(&sb, "]");
+    array = sb_corpus("array", &sb);
+
+    out_size = ndjson.len + numbers.len + 65536;
+    out = malloc(out_size);
+
+    // inputs derived from the corpora
+    jsonSpan span;
+    jsonExtractSpan(escaped.json, escaped.len, "s0", &span);
+    raw_text = malloc(span.len + 1);
+    jsonUnescapeN(escaped.json + span.offset + 1, span.len - 2, raw_text, span.len + 1);
+    raw_len = strlen(raw_text);
+    quoted_text = malloc(span.len + 1);
+    jsonSpanCopy(escaped.json, &span, quoted_text, span.len + 1);
+
+    flat_tokens = malloc(256 * sizeof(jsonToken));
+    flat_token_count = jsonTokenize(flat.json, flat_tokens, 256);
+    numbers_tokens = malloc(20000 * sizeof(jsonToken));
+    numbers_token_count = jsonTokenize(numbers.json, numbers_tokens, 20000);
+}
+
+// ---- runner ----
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x>y) - (x<y);
+}
+
+static void bench(const char *name, const corpus *c, size_t bytes, void (*op)(void)) {
+    static uint64_t samples[MAX_SAMPLES];
+    char label[128];
+    long batch = 1, ops = 0, i;
+    int count = 0;
+    uint64_t start, elapsed, total = 0;
+
+    if (chunk_size) snprintf(label, sizeof(label), "%s/%d", name, chunk_size);
+    else snprintf(label, sizeof(label), "%s", name);
+    if (filter && !strstr(label, filter) && !strstr(c->name, filter)) return;
+
+    op(); // warm up
+    while (1) { // batch long enough to time
+        start = now_ns();
+        for (i=0; i<batch; i++) op();
+        elapsed = now_ns() - start;
+        if ((elapsed>=SAMPLE_NS) || (batch>=(1L<<30))) break;
+        batch *= 2;
+    }
+    while ((count<MAX_SAMPLES) && (total < (uint64_t)budget_ms*1000000)) {
+        start = now_ns();
+        for (i=0; i<batch; i++) op();
+        elapsed = now_ns() - start;
+        samples[count++] = elapsed;
+        total += elapsed;
+        ops += batch;
+    }
+    qsort(samples, count, sizeof(samples[0]), cmp_u64);
+    double ns_op = (double)total / ops;
+    printf("%s\t%s\t%zu\t%ld\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n", label, c->name, bytes, ops,
+        ns_op, (ns_op>0) ? bytes*1000.0/ns_op : 0.0,
+        (double)samples[count*50/100] / batch, (double)samples[count*90/100] / batch,
+        (double)samples[count*99/100] / batch);
+    fflush(stdout);
+}
+
+// ---- operations ----
+
+static void b_trim(void) { sink += (long)jsonTrim(flat.json, out); }
+static void b_trim_n(void) { sink += (long)jsonTrimN(flat.json, flat.len, out); }
+static void b_remove_spacing_flat(void) { sink += (long)jsonRemoveSpacing(flat.json, out); }
+static void b_remove_spacing_deep(void) { sink += (long)jsonRemoveSpacing(deep.json, out); }
+static void b_remove_spacing_ndjson(void) { sink += (long)jsonRemoveSpacingN(ndjson.json, ndjson.len, out); }
+static int b_minify_out(void *ctx, const char *data, size_t len) { sink += len; return 1; }
+static void b_project_flat(void) { // keep 2 of the members
+    static const char *keys[] = { "id", "last" };
+    jsonProject project;
+    jsonProjectInit(&project, keys, 2, 0, b_minify_out, NULL);
+    jsonProjectWrite(&project, flat.json, flat.len);
+}
+static void b_project_ndjson(void) { // drop 1 member of every line, 64KB reads
+    static const char *keys[] = { "id" };
+    jsonProject project;
+    size_t i;
+    jsonProjectInit(&project, keys, 1, 1, b_minify_out, NULL);
+    for (i=0; i<ndjson.len; i+=65536) {
+        jsonProjectWrite(&project, ndjson.json+i, (ndjson.len-i<65536) ? ndjson.len-i : 65536);
+    }
+}
+static void b_minify_ndjson(void) { // 64KB reads, as from a pipe
+    jsonMinify minify;
+    size_t i;
+    jsonMinifyInit(&minify, b_minify_out, NULL);
+    for (i=0; i<ndjson.len; i+=65536) {
+        jsonMinifyWrite(&minify, ndjson.json+i, (ndjson.len-i<65536) ? ndjson.len-i : 65536);
+    }
+}
+static void b_extract(void) { sink += (long)jsonExtract(flat.json, "last", out, 64); }
+static void b_extract_first(void) { sink += (long)jsonExtract(flat.json, "id", out, 64); }
+static void b_extract_n(void) { sink += (long)jsonExtractN(flat.json, flat.len, "last", out, 64); }
+static void b_extract_deep(void) { sink += (long)jsonExtract(deep.json, "leaf", out, 64); }
+static void b_extract_string(void) { sink += (long)jsonExtract(escaped.json, "s15", out, out_size); }
+static void b_extract_span(void) {
+    jsonSpan span;
+    sink += jsonExtractSpan(flat.json, flat.len, "last", &span);
+}
+static void b_extract_many(void) {
+    static const char *keys[] = { "id", "ts", "temp", "ok", "mode", "last" };
+    jsonSpan spans[6];
+    sink += jsonExtractMany(flat.json, flat.len, keys, spans, 6);
+}
+static void b_extract_many_loop(void) { // what jsonExtractMany replaces
+    static const char *keys[] = { "id", "ts", "temp", "ok", "mode", "last" };
+    jsonSpan span;
+    int i;
+    for (i=0; i<6; i++) sink += jsonExtractSpan(flat.json, flat.len, keys[i], &span);
+}
+static void b_extract_span_trusted(void) {
+    jsonSpan span;
+    sink += jsonExtractSpanTrusted(flat.json, flat.len, "last", &span);
+}
+static void b_extract_value(void) {
+    jsonValue value;
+    sink += jsonExtractValue(flat.json, flat.len, "temp", &value);
+}
+static void b_extract_int64(void) { int64_t v; sink += jsonExtractInt64(flat.json, "ts", &v); }
+static void b_extract_double(void) { double v; sink += jsonExtractDouble(flat.json, "lat", &v); }
+static void b_extract_bool(void) { int v; sink += jsonExtractBool(flat.json, "ok", &v); }
+static void b_index_list(void) { sink += (long)jsonIndexList(numbers_body, 9999, out, 64); }
+static void b_index_list_n(void) {
+    sink += (long)jsonIndexListN(numbers_body, numbers_body_len, 9999, out, 64);
+}
+static void b_index_list_trusted(void) {
+    jsonSpan span;
+    sink += jsonIndexListSpanTrusted(numbers_body, numbers_body_len, 9999, &span);
+}
+static void b_list_walk(void) {
+    jsonCursor cursor;
+    jsonSpan span;
+    jsonListInit(&cursor, numbers.json, numbers.len);
+    while (jsonListNext(&cursor, &span)) ;
+    sink += cursor.count;
+}
+static void b_list_walk_array(void) { // the serial counterpart of b_split_array
+    jsonCursor cursor;
+    jsonSpan span;
+    jsonListInit(&cursor, array.json, array.len);
+    while (jsonListNext(&cursor, &span)) sink += span.len;
+}
+static int b_split_element(void *ctx, const char *json, const jsonSpan *span) {
+    __atomic_fetch_add(&sink, span->len, __ATOMIC_RELAXED);
+    return 1;
+}
+static void b_split_array_1(void) { sink += jsonSplitArray(array.json, array.len, 1, b_split_element, NULL); }
+static void b_split_array_4(void) { sink += jsonSplitArray(array.json, array.len, 4, b_split_element, NULL); }
+static int b_sax_event(void *ctx, const jsonEvent *event) { sink += event->type; return 1; }
+static void b_sax(const corpus *c, size_t chunk) {
+    jsonSax sax;
+    size_t i;
+    jsonSaxInit(&sax, b_sax_event, NULL);
+    for (i=0; i<c->len; i+=chunk) jsonSaxWrite(&sax, c->json+i, (c->len-i<chunk) ? c->len-i : chunk);
+    sink += jsonSaxEnd(&sax);
+}
+static void b_sax_flat(void) { b_sax(&flat, flat.len); }
+static void b_sax_deep(void) { b_sax(&deep, deep.len); }
+static void b_sax_escaped(void) { b_sax(&escaped, 4096); }
+static void b_sax_ndjson(void) { b_sax(&ndjson, 65536); }
+static void b_list_items(void) {
+    jsonCursor cursor;
+    jsonListInit(&cursor, numbers.json, numbers.len);
+    while (jsonListNextItem(&cursor, out, 64)) ;
+    sink += cursor.count;
+}
+static void b_object_walk_node(jsonCursor *cursor, int is_object) {
+    jsonSpan key, value;
+    jsonCursor child;
+    while ((is_object) ? jsonObjectNext(cursor, &key, &value) : jsonListNext(cursor, &value)) {
+        if (jsonCursorEnter(cursor, &value, &child)) b_object_walk_node(&child, value.type==JSON_OBJECT);
+        sink++;
+    }
+}
+static void b_object_walk_flat(void) {
+    jsonCursor cursor;
+    jsonObjectInit(&cursor, flat.json, flat.len);
+    cursor.walk = 1;
+    b_object_walk_node(&cursor, 1);
+}
+static void b_object_walk_deep(void) {
+    jsonCursor cursor;
+    jsonObjectInit(&cursor, deep.json, deep.len);
+    cursor.walk = 1;
+    b_object_walk_node(&cursor, 1);
+}
+static void b_query_flat(void) { sink += (long)jsonQuery(flat.json, "last", out, 64); }
+static void b_query_deep(void) {
+    jsonSpan span;
+    sink += jsonQuerySpan(deep.json, deep.len, deep_path, &span);
+}
+static void b_span_copy(void) {
+    jsonSpan span = { 0, flat.len, JSON_OBJECT };
+    sink += (long)jsonSpanCopy(flat.json, &span, out, out_size);
+}
+static void b_validate_flat(void) { sink += jsonValidate(flat.json, flat.len, NULL); }
+static void b_validate_deep(void) { sink += jsonValidate(deep.json, deep.len, NULL); }
+static void b_validate_escaped(void) { sink += jsonValidate(escaped.json, escaped.len, NULL); }
+static void b_validate_numbers(void) { sink += jsonValidate(numbers.json, numbers.len, NULL); }
+static void b_memcpy_escaped(void) { // what jsonValidate is measured against
+    memcpy(out, escaped.json, escaped.len);
+    sink += out[0];
+}
+static char dom_arena[1 << 20];
+static void b_dom_parse_flat(void) {
+    jsonDom dom;
+    jsonDomInit(&dom, dom_arena, sizeof(dom_arena));
+    sink += (long)jsonDomParse(&dom, flat.json, flat.len);
+}
+static void b_dom_parse_deep(void) {
+    jsonDom dom;
+    jsonDomInit(&dom, dom_arena, sizeof(dom_arena));
+    sink += (long)jsonDomParse(&dom, deep.json, deep.len);
+}
+static void b_dom_get(void) { // parse once, look up the fields of b_extract_many
+    static const char *keys[] = { "id", "ts", "temp", "ok", "device", "last" };
+    jsonDom dom;
+    int i;
+    jsonDomInit(&dom, dom_arena, sizeof(dom_arena));
+    const jsonNode *root = jsonDomParse(&dom, flat.json, flat.len);
+    for (i=0; i<6; i++) sink += (long)jsonDomGet(&dom, root, keys[i]);
+}
+static char *flat_bin, *deep_bin;
+static long flat_bin_len, deep_bin_len;
+static void b_bin_encode_flat(void) { sink += jsonBinEncode(flat.json, flat.len, out, out_size); }
+static void b_bin_encode_deep(void) { sink += jsonBinEncode(deep.json, deep.len, out, out_size); }
+static void b_bin_decode_flat(void) {
+    jsonSpan root;
+    jsonBinRoot(flat_bin, flat_bin_len, &root);
+    sink += jsonBinDecode(flat_bin, &root, out, out_size);
+}
+static void b_bin_get(void) { // the binary counterpart of b_extract
+    jsonSpan root, span;
+    jsonBinRoot(flat_bin, flat_bin_len, &root);
+    sink += jsonBinGet(flat_bin, &root, "last", &span);
+}
+static void b_bin_get_deep(void) { // the binary counterpart of b_query_deep
+    jsonSpan span;
+    const char *p = deep_path, *end;
+    char name[64];
+    jsonBinRoot(deep_bin, deep_bin_len, &span);
+    while (*p) { // name or name[index], dot separated
+        end = p + strcspn(p, ".[");
+        memcpy(name, p, end-p);
+        name[end-p] = '\0';
+        if (!jsonBinGet(deep_bin, &span, name, &span)) break;
+        if ((*end=='[') && !jsonBinIndex(deep_bin, &span, atoi(end+1), &span)) break;
+        p = end + strcspn(end, ".");
+        if (*p) p++;
+    }
+    sink += span.len + (*p==0);
+}
+static void b_escape(void) { sink += (long)jsonEscapeN(raw_text, raw_len, out, out_size); }
+static void b_escape_nul(void) { sink += (long)jsonEscape(raw_text, out, out_size); }
+static void b_escape_measure(void) { sink += jsonEscapeTo(raw_text, raw_len, NULL, 0); }
+static void b_unescape(void) { sink += (long)jsonUnescape(quoted_text+1, out, out_size); }
+static void b_unescape_n(void) {
+    jsonUnescapeN(escaped.json, escaped.len, out, out_size);
+    sink += out[0];
+}
+static void b_quote(void) { sink += (long)jsonQuote(raw_text, out, out_size); }
+static void b_unquote(void) { sink += (long)jsonUnquote(quoted_text, out, out_size); }
+static void b_append_item(void) {
+    static const char *keys[] = { "a", "bb", "ccc", "dddd", "e", "f", "g", "h" };
+    int i;
+    out[0] = '\0';
+    for (i=0; i<8; i++) jsonAppendItem(keys[i], "\"value\"", out, 512);
+    sink += out[1];
+}
+static void b_get_key_value(void) {
+    char key[64], value[64];
+    sink += jsonGetKeyValue(flat.json+1, key, value, sizeof(key));
+}
+static void b_build(void) {
+    jsonBuilder b;
+    jsonBuildInit(&b, out, 1024);
+    jsonBuildObject(&b, NULL);
+    jsonBuildInt(&b, "id", 12345);
+    jsonBuildInt(&b, "ts", 1700000000123LL);
+    jsonBuildString(&b, "device", "dev-00ff");
+    jsonBuildDouble(&b, "temp", 21.5);
+    jsonBuildBool(&b, "ok", 1);
+    jsonBuildNull(&b, "tag");
+    jsonBuildArray(&b, "list");
+    jsonBuildInt(&b, NULL, 1);
+    jsonBuildInt(&b, NULL, 2);
+    jsonBuildEnd(&b);
+    jsonBuildRaw(&b, "raw", "{\"x\":1}");
+    jsonBuildString(&b, "note", "reading \"7\"\n");
+    jsonBuildEnd(&b);
+    sink += b.len;
+}
+static void b_tokenize_flat(void) {
+    jsonToken tokens[256];
+    sink += jsonTokenize(flat.json, tokens, 256);
+}
+static void b_tokenize_deep(void) {
+    static jsonToken tokens[2048];
+    sink += jsonTokenizeN(deep.json, deep.len, tokens, 2048);
+}
+static void b_tokenize_numbers(void) {
+    sink += jsonTokenizeN(numbers.json, numbers.len, numbers_tokens, 20000);
+}
+static void b_token_find(void) {
+    sink += jsonTokenFind(flat.json, flat_tokens, flat_token_count, 0, "last");
+}
+static void b_token_extract(void) {
+    sink += (long)jsonTokenExtract(flat.json, flat_tokens, flat_token_count, "last", out, 64);
+}
+static void b_token_copy(void) {
+    sink += (long)jsonTokenCopy(flat.json, &flat_tokens[0], out, out_size);
+}
+static void b_token_child(void) {
+    sink += jsonTokenChild(numbers_tokens, numbers_token_count, 0, 9999);
+}
+static void b_token_index_list(void) {
+    sink += (long)jsonTokenIndexList(numbers.json, numbers_tokens, numbers_token_count, 9999, out, 64);
+}
+static void b_token_get_key_value(void) {
+    char key[64], value[64];
+    sink += jsonTokenGetKeyValue(flat.json, flat_tokens, flat_token_count, 1, key, value, 64);
+}
+static void b_parse_double(void) {
+    jsonCursor cursor;
+    jsonSpan span;
+    double v;
+    jsonListInit(&cursor, numbers.json, numbers.len);
+    while (jsonListNext(&cursor, &span)) sink += jsonParseDouble(numbers.json + span.offset, span.len, &v);
+}
+static void b_parse_double_strtod(void) { // what jsonParseDouble replaces
+    jsonCursor cursor;
+    jsonSpan span;
+    jsonListInit(&cursor, numbers.json, numbers.len);
+    while (jsonListNext(&cursor, &span)) {
+        char buff[64];
+        memcpy(buff, numbers.json + span.offset, span.len);
+        buff[span.len] = '\0';
+        sink += (long)strtod(buff, NULL);
+    }
+}
+static void b_parse_int64(void) {
+    jsonCursor cursor;
+    jsonSpan span;
+    int64_t v;
+    jsonListInit(&cursor, numbers.json, numbers.len);
+    while (jsonListNext(&cursor, &span)) sink += jsonParseInt64(numbers.json + span.offset, span.len, &v);
+}
+static void b_decode_value(void) {
+    jsonCursor cursor;
+    jsonSpan span;
+    jsonValue value;
+    jsonListInit(&cursor, numbers.json, numbers.len);
+    while (jsonListNext(&cursor, &span)) sink += jsonDecodeValue(numbers.json, &span, &value);
+}
+
+typedef struct {
+    int id;
+    int64_t ts;
+    double temp;
+    int ok;
+    char device[16];
+    char mode[8];
+    int last;
+} telemetry;
+
+static jsonSchema schema;
+static void b_schema_decode(void) {
+    telemetry t;
+    sink += jsonSchemaDecode(&schema, flat.json, flat.len, &t);
+}
+static void b_schema_compile(void) {
+    static const jsonField fields[] = {
+        JSON_FIELD(telemetry, id, JSON_FIELD_INT),
+        JSON_FIELD(telemetry, ts, JSON_FIELD_INT64),
+        JSON_FIELD(telemetry, temp, JSON_FIELD_DOUBLE),
+        JSON_FIELD(telemetry, ok, JSON_FIELD_BOOL),
+        JSON_FIELD(telemetry, device, JSON_FIELD_STRING),
+        JSON_FIELD(telemetry, mode, JSON_FIELD_STRING),
+        JSON_FIELD(telemetry, last, JSON_FIELD_INT),
+    };
+    sink += jsonSchemaCompile(&schema, fields, sizeof(fields)/sizeof(fields[0]));
+}
+
+// whole ndjson corpus through the ring-buffer stream, chunk_size at a time
+static void b_stream(void) {
+    static char ring[1 << 16];
+    jsonStream stream;
+    char key[128], value[256];
+    size_t pos = 0;
+    jsonStreamInit(&stream, ring, sizeof(ring));
+    while (pos<ndjson.len) {
+        size_t n = ((size_t)chunk_size < ndjson.len-pos) ? (size_t)chunk_size : ndjson.len-pos;
+        pos += jsonStreamFeed(&stream, ndjson.json + pos, n);
+        while (jsonStreamNext(&stream, key, value, sizeof(key))) sink++;
+    }
+}
+
+// same through the legacy jsonStreamKeyValues
+static void b_stream_key_values(void) {
+    static char buffer[1 << 16], chunk[8192];
+    char key[128], value[256];
+    int last_offset = 0, ret;
+    size_t pos = 0;
+    buffer[0] = '\0';
+    while (pos<ndjson.len) {
+        size_t n = ((size_t)chunk_size < ndjson.len-pos) ? (size_t)chunk_size : ndjson.len-pos;
+        memcpy(chunk, ndjson.json + pos, n);
+        chunk[n] = '\0';
+        pos += n;
+        ret = jsonStreamKeyValues(chunk, buffer, sizeof(buffer), last_offset, &last_offset);
+        while (ret>0) {
+            sink += jsonGetKeyValue(buffer+ret, key, value, sizeof(key));
+            ret = jsonStreamKeyValues(NULL, buffer, sizeof(buffer), last_offset, &last_offset);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int i;
+    for (i=1; i<argc; i++) {
+        if ((strcmp(argv[i], "-t")==0) && (i+1<argc)) budget_ms = atoi(argv[++i]);
+        else filter = argv[i];
+    }
+    gen_corpora();
+    b_schema_compile();
+    flat_bin = malloc(flat.len*2);
+    flat_bin_len = jsonBinEncode(flat.json, flat.len, flat_bin, flat.len*2);
+    deep_bin = malloc(deep.len*2);
+    deep_bin_len = jsonBinEncode(deep.json, deep.len, deep_bin, deep.len*2);
+    fprintf(stderr, "binary: flat %zu -> %ld bytes, deep %zu -> %ld bytes\n", 
+        flat.len, flat_bin_len, deep.len, deep_bin_len);
+
+    printf("name\tcorpus\tbytes\tops\tns_op\tmb_s\tp50_ns\tp90_ns\tp99_ns\n");
+    bench("jsonTrim", &flat, flat.len, b_trim);
+    bench("jsonTrimN", &flat, flat.len, b_trim_n);
+    bench("jsonRemoveSpacing", &flat, flat.len, b_remove_spacing_flat);
+    bench("jsonRemoveSpacing", &deep, deep.len, b_remove_spacing_deep);
+    bench("jsonRemoveSpacingN", &ndjson, ndjson.len, b_remove_spacing_ndjson);
+    bench("jsonMinifyWrite(64K)", &ndjson, ndjson.len, b_minify_ndjson);
+    bench("jsonSaxWrite", &flat, flat.len, b_sax_flat);
+    bench("jsonSaxWrite", &deep, deep.len, b_sax_deep);
+    bench("jsonSaxWrite(4K)", &escaped, escaped.len, b_sax_escaped);
+    bench("jsonSaxWrite(64K)", &ndjson, ndjson.len, b_sax_ndjson);
+    bench("jsonProjectWrite(allow 2)", &flat, flat.len, b_project_flat);
+    bench("jsonProjectWrite(deny 1,64K)", &ndjson, ndjson.len, b_project_ndjson);
+    bench("jsonExtract", &flat, flat.len, b_extract);
+    bench("jsonExtract(first)", &flat, flat.len, b_extract_first);
+    bench("jsonExtractN", &flat, flat.len, b_extract_n);
+    bench("jsonExtract", &deep, deep.len, b_extract_deep);
+    bench("jsonExtract", &escaped, escaped.len, b_extract_string);
+    bench("jsonExtractSpan", &flat, flat.len, b_extract_span);
+    bench("jsonExtractSpanTrusted", &flat, flat.len, b_extract_span_trusted);
+    bench("jsonExtractMany(6)", &flat, flat.len, b_extract_many);
+    bench("jsonExtractSpan(6x)", &flat, flat.len, b_extract_many_loop);
+    bench("jsonExtractValue", &flat, flat.len, b_extract_value);
+    bench("jsonExtractInt64", &flat, flat.len, b_extract_int64);
+    bench("jsonExtractDouble", &flat, flat.len, b_extract_double);
+    bench("jsonExtractBool", &flat, flat.len, b_extract_bool);
+    bench("jsonQuery", &flat, flat.len, b_query_flat);
+    bench("jsonQuerySpan", &deep, deep.len, b_query_deep);
+    bench("jsonSpanCopy", &flat, flat.len, b_span_copy);
+    bench("jsonIndexList(last)", &numbers, numbers_body_len, b_index_list);
+    bench("jsonIndexListN(last)", &numbers, numbers_body_len, b_index_list_n);
+    bench("jsonIndexListSpanTrusted(last)", &numbers, numbers_body_len, b_index_list_trusted);
+    bench("jsonListNext(all)", &numbers, numbers.len, b_list_walk);
+    bench("jsonListNext(all)", &array, array.len, b_list_walk_array);
+    bench("jsonSplitArray(1 thread)", &array, array.len, b_split_array_1);
+    bench("jsonSplitArray(4 threads)", &array, array.len, b_split_array_4);
+    bench("jsonListNextItem(all)", &numbers, numbers.len, b_list_items);
+    bench("jsonObjectNext(all)", &flat, flat.len, b_object_walk_flat);
+    bench("jsonObjectNext(all)", &deep, deep.len, b_object_walk_deep);
+    bench("jsonParseDouble(all)", &numbers, numbers.len, b_parse_double);
+    bench("strtod(all)", &numbers, numbers.len, b_parse_double_strtod);
+    bench("jsonParseInt64(all)", &numbers, numbers.len, b_parse_int64);
+    bench("jsonDecodeValue(all)", &numbers, numbers.len, b_decode_value);
+    bench("jsonValidate", &flat, flat.len, b_validate_flat);
+    bench("jsonValidate", &deep, deep.len, b_validate_deep);
+    bench("jsonValidate", &escaped, escaped.len, b_validate_escaped);
+    bench("jsonValidate", &numbers, numbers.len, b_validate_numbers);
+    bench("memcpy", &escaped, escaped.len, b_memcpy_escaped);
+    bench("jsonDomParse", &flat, flat.len, b_dom_parse_flat);
+    bench("jsonDomParse", &deep, deep.len, b_dom_parse_deep);
+    bench("jsonDomParse+Get(6)", &flat, flat.len, b_dom_get);
+    bench("jsonBinEncode", &flat, flat.len, b_bin_encode_flat);
+    bench("jsonBinEncode", &deep, deep.len, b_bin_encode_deep);
+    bench("jsonBinDecode", &flat, flat.len, b_bin_decode_flat);
+    bench("jsonBinGet", &flat, flat.len, b_bin_get);
+    bench("jsonBinGet(path)", &deep, deep.len, b_bin_get_deep);
+    bench("jsonEscapeN", &escaped, raw_len, b_escape);
+    bench("jsonEscape", &escaped, raw_len, b_escape_nul);
+    bench("jsonEscapeTo(measure)", &escaped, raw_len, b_escape_measure);
+    bench("jsonUnescape", &escaped, strlen(quoted_text), b_unescape);
+    bench("jsonUnescapeN", &escaped, escaped.len, b_unescape_n);
+    bench("jsonQuote", &escaped, raw_len, b_quote);
+    bench("jsonUnquote", &escaped, strlen(quoted_text), b_unquote);
+    bench("jsonAppendItem(8)", &flat, 0, b_append_item);
+    bench("jsonGetKeyValue", &flat, flat.len, b_get_key_value);
+    bench("jsonBuild", &flat, 0, b_build);
+    bench("jsonSchemaCompile", &flat, 0, b_schema_compile);
+    bench("jsonSchemaDecode", &flat, flat.len, b_schema_decode);
+    bench("jsonTokenize", &flat, flat.len, b_tokenize_flat);
+    bench("jsonTokenizeN", &deep, deep.len, b_tokenize_deep);
+    bench("jsonTokenizeN", &numbers, numbers.len, b_tokenize_numbers);
+    bench("jsonTokenFind", &flat, flat.len, b_token_find);
+    bench("jsonTokenExtract", &flat, flat.len, b_token_extract);
+    bench("jsonTokenCopy", &flat, flat.len, b_token_copy);
+    bench("jsonTokenGetKeyValue", &flat, flat.len, b_token_get_key_value);
+    bench("jsonTokenChild(last)", &numbers, numbers.len, b_token_child);
+    bench("jsonTokenIndexList(last)", &numbers, numbers.len, b_token_index_list);
+    for (chunk_size=1; chunk_size<=4096; chunk_size*=2) {
+        bench("jsonStream", &ndjson, ndjson.len, b_stream);
+    }
+    for (chunk_size=1; chunk_size<=4096; chunk_size*=2) {
+        bench("jsonStreamKeyValues", &ndjson, ndjson.len, b_stream_key_values);
+    }
+    chunk_size = 0;
+    return 0;
+}
@@ -0,0 +1,119 @@
+/* epoll_test.c  */
+/* Tests of the epoll driver (lightcjson_epoll.c), Linux only: make epoll */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "lightcjson.h"
+#include "lightcjson_epoll.h"
+
+int test_jsonLoop();
+int t_jsonLoopEvent(jsonConn *conn, const jsonEvent *event);
+void t_jsonLoopClose(jsonConn *conn, int error);
+
+int expect_num(int is, int expect, char *name);
+int expect_str(char *is, char *expect, char *name);
+
+int main() {
+    printf("\nTests of the lightcjson epoll driver\n\n");
+    int fail=0;
+    fail += test_jsonLoop();
+
+    printf("\nTests failed: %d\n", fail);
+    return 0;
+}
+
+int expect_num(int is, int expect, char *name) {
+    if (expect != is) {
+        printf("  %s: expected %d, was %d\n", name, expect, is);
+        return 1;
+    }
+    return 0;
+}
+
+int expect_str(char *is, char *expect, char *name) {
+    if (strcmp(expect,is)!=0) {
+        printf("  %s: expected %s, was %s\n", name, expect, is);
+        return 1;
+    }
+    return 0;
+}
+
+jsonConn *t_loop_victim; // closed by a "kill" member of another connection
+
+// conn->user is a trace: key=value per event, "#error" when closed.
+// "stop" returns 0, "quit" closes conn, "kill" closes t_loop_victim
+int t_jsonLoopEvent(jsonConn *conn, const jsonEvent *event) {
+    char *out = conn->user, *end = out + strlen(out);
+    const char *names = " {}[]ksntf0";
+    end += sprintf(end, "%s=%c", conn->key, names[event->type]);
+    if ((event->type==JSON_EVENT_STRING) || (event->type==JSON_EVENT_NUMBER)) {
+        end += sprintf(end, "%.*s", (int)event->len, event->data);
+    }
+    strcpy(end, " ");
+    if (strcmp(conn->key, "quit")==0) jsonLoopClose(conn, 5);
+    if (strcmp(conn->key, "kill")==0) jsonLoopClose(t_loop_victim, 7);
+    return strcmp(conn->key, "stop")!=0;
+}
+
+// a killed conn is wiped, as if freed and reused
+void t_jsonLoopClose(jsonConn *conn, int error) {
+    char *out = conn->user;
+    sprintf(out + strlen(out), "#%d", error);
+    if (error==7) memset(conn, 0, sizeof(*conn));
+}
+
+int test_jsonLoop() {
+    int run=0, fail=0, i, fds[3][2];
+    char out[3][512] = { "", "", "" };
+    char *pieces[] = { "{\"a\": {\"b\"", ": [1, \"x", "y\"]}, \"c\": tr", "ue}\n{\"d\"", ":null}\n" };
+    jsonLoop loop;
+    jsonConn conns[3];
+
+    printf("Testing jsonLoop\n");
+    run++; fail+=expect_num(jsonLoopInit(&loop, t_jsonLoopEvent, t_jsonLoopClose), 1, "init");
+    for (i=0; i<3; i++) {
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]);
+        jsonLoopAdd(&loop, &conns[i], fds[i][0], out[i]);
+    }
+    // JSON trickles in, the loop serves whatever is ready
+    for (i=0; i<5; i++) {
+        write(fds[0][1], pieces[i], strlen(pieces[i]));
+        while (jsonLoopRun(&loop, 0)>0) ;
+    }
+    run++; fail+=expect_str(out[0], "={ a={ b=[ =n1 =sxy =] =} c=t =} ={ d=0 =} ", "events with keys");
+    close(fds[0][1]);
+    write(fds[1][1], "[1, }", 5);
+    write(fds[2][1], "{\"x\": 1, \"stop\": 2, \"y\": 3}", 27);
+    while (loop.count && (jsonLoopRun(&loop, 100)>0)) ;
+    run++; fail+=expect_str(out[0] + strlen(out[0]) - 2, "#0", "end of input");
+    run++; fail+=expect_str(out[1], "=[ =n1 #1", "invalid");
+    run++; fail+=expect_num((int)conns[1].sax.error_offset, 4, "invalid offset");
+    run++; fail+=expect_str(out[2], "={ x=n1 stop=n2 #-2", "closed by on_event");
+    run++; fail+=expect_num(loop.count, 0, "all closed");
+    for (i=1; i<3; i++) close(fds[i][1]);
+
+    // closed from on_event: no more events of that read, on_close after the
+    // batch, so the wiped victim is not served with the rest of the batch
+    for (i=0; i<3; i++) {
+        out[i][0] = '\0';
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]);
+        jsonLoopAdd(&loop, &conns[i], fds[i][0], out[i]);
+    }
+    t_loop_victim = &conns[2];
+    write(fds[0][1], "{\"x\": 1, \"quit\": 2, \"y\": 3}", 27);
+    write(fds[1][1], "{\"kill\": 1}", 11);
+    write(fds[2][1], "{\"v\": 1}", 8);
+    jsonLoopRun(&loop, 100);
+    run++; fail+=expect_str(out[0], "={ x=n1 quit=n2 #5", "closed in on_event");
+    run++; fail+=expect_str(out[1], "={ kill=n1 =} ", "closed another");
+    run++; fail+=expect_str(out[2], "#7", "closed by another");
+    run++; fail+=expect_num(loop.count, 1, "one left");
+    for (i=0; i<3; i++) close(fds[i][1]);
+    while (loop.count && (jsonLoopRun(&loop, 100)>0)) ;
+    jsonLoopFree(&loop);
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
@@ -0,0 +1,176 @@
+/* loadgen.c  */
+/* Load generator for the epoll driver (lightcjson_epoll.c).
+
+   usage: tests/loadgen.o [-c conns] [-m messages] [-p piece]
+
+   A writer thread trickles JSON Lines messages into conns socketpairs:
+   every message is cut into writes of 1..piece bytes and the writes of all
+   connections are interleaved. Each message ends with "t", the time its
+   last piece was written; the loop on the main thread measures the time
+   from there to the "t" event. Output is tab separated: connections,
+   messages, events, events/s, MB/s, bytes per connection and the 50/90/99th
+   percentile and max latency in us.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include "lightcjson.h"
+#include "lightcjson_epoll.h"
+
+typedef struct {
+    int conns, messages, piece;
+    int *fds;                   // writer ends
+} writer_job;
+
+static uint64_t *latencies;     // ns per message
+static long latency_count, event_count;
+static size_t byte_count;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t rnd_state = 88172645463325252ULL;
+static uint64_t rnd(void) {
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 7;
+    rnd_state ^= rnd_state << 17;
+    return rnd_state;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x>y) - (x<y);
+}
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len) {
+        ssize_t n = write(fd, data, len);
+        if (n<=0) return 0;
+        data += n;
+        len -= n;
+    }
+    return 1;
+}
+
+static void *writer(void *arg) {
+    writer_job *job = arg;
+    char (*heads)[160] = malloc(job->conns * sizeof(*heads));
+    size_t *sent = calloc(job->conns, sizeof(size_t));
+    int m, i, pending;
+
+    for (m=0; m<job->messages; m++) {
+        for (i=0; i<job->conns; i++) {
+            snprintf(heads[i], sizeof(heads[i]), "{\"id\":%d, \"seq\":%d, \"temp\":%.2f, "
+                "\"ok\":true, \"note\":\"reading \\\"%d\\\"\", \"tags\":[\"a\",\"b\"], \"t\":",
+                i, m, (double)(rnd()%10000)/100, m);
+            sent[i] = 0;
+        }
+        // one piece of every connection per pass, the time stamp last
+        do {
+            pending = 0;
+            for (i=0; i<job->conns; i++) {
+                size_t len = strlen(heads[i]);
+                if (sent[i]>len) continue;
+                if (sent[i]<len) {
+                    size_t n = 1 + rnd() % job->piece;
+                    if (n>len-sent[i]) n = len-sent[i];
+                    write_all(job->fds[i], heads[i]+sent[i], n);
+                    sent[i] += n;
+                } else {
+                    char tail[32];
+                    int n = snprintf(tail, sizeof(tail), "%llu}\n", (unsigned long long)now_ns());
+                    write_all(job->fds[i], tail, n);
+                    sent[i]++;
+                }
+                pending = 1;
+            }
+        } while (pending);
+    }
+    for (i=0; i<job->conns; i++) close(job->fds[i]);
+    free(heads);
+    free(sent);
+    return NULL;
+}
+
+static int on_event(jsonConn *conn, const jsonEvent *event) {
+    event_count++;
+    if ((event->type==JSON_EVENT_NUMBER) && (conn->key_len==1) && (conn->key[0]=='t')) {
+        int64_t t;
+        if (jsonParseInt64(event->data, event->len, &t)) latencies[latency_count++] = now_ns() - t;
+    }
+    return 1;
+}
+
+static void on_close(jsonConn *conn, int error) {
+    byte_count += conn->sax.offset;
+    if (error) fprintf(stderr, "connection %ld closed with error %d\n", (long)(intptr_t)conn->user, error);
+}
+
+int main(int argc, char **argv) {
+    writer_job job = { 2000, 50, 16, NULL };
+    struct rlimit rl;
+    jsonLoop *loop = malloc(sizeof(jsonLoop));
+    jsonConn *conns;
+    pthread_t tid;
+    int opt, i, pair[2];
+
+    while ((opt = getopt(argc, argv, "c:m:p:"))!=-1) {
+        switch (opt) {
+        case 'c': job.conns = atoi(optarg); break;
+        case 'm': job.messages = atoi(optarg); break;
+        case 'p': job.piece = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: loadgen [-c conns] [-m messages] [-p piece]\n");
+            return 2;
+        }
+    }
+    if (job.piece<1) job.piece = 1;
+    // two fds per connection
+    if (getrlimit(RLIMIT_NOFILE, &rl)==0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        if ((rlim_t)job.conns*2 + 16 > rl.rlim_cur) job.conns = (rl.rlim_cur - 16) / 2;
+    }
+
+    conns = calloc(job.conns, sizeof(jsonConn));
+    job.fds = calloc(job.conns, sizeof(int));
+    latencies = malloc((size_t)job.conns * job.messages * sizeof(uint64_t));
+    if (!loop || !conns || !job.fds || !latencies || !jsonLoopInit(loop, on_event, on_close)) {
+        perror("loadgen"); return 1;
+    }
+    for (i=0; i<job.conns; i++) {
+        if ((socketpair(AF_UNIX, SOCK_STREAM, 0, pair)<0) ||
+            !jsonLoopAdd(loop, &conns[i], pair[0], (void *)(intptr_t)i)) {
+            perror("socketpair"); return 1;
+        }
+        job.fds[i] = pair[1];
+    }
+
+    uint64_t start = now_ns();
+    pthread_create(&tid, NULL, writer, &job);
+    while (loop->count) {
+        if (jsonLoopRun(loop, 1000)<0) { perror("epoll_wait"); return 1; }
+    }
+    double elapsed = (now_ns() - start) / 1e9;
+    pthread_join(tid, NULL);
+    jsonLoopFree(loop);
+
+    qsort(latencies, latency_count, sizeof(uint64_t), cmp_u64);
+    printf("conns\tmessages\tevents\tevents_s\tmb_s\tconn_bytes\tp50_us\tp90_us\tp99_us\tmax_us\n");
+    if (!latency_count) return 1;
+    printf("%d\t%ld\t%ld\t%.0f\t%.1f\t%zu\t%.1f\t%.1f\t%.1f\t%.1f\n", job.conns, latency_count,
+        event_count, event_count / elapsed, byte_count / elapsed / 1e6, sizeof(jsonConn),
+        latencies[latency_count*50/100] / 1e3, latencies[latency_count*90/100] / 1e3,
+        latencies[latency_count*99/100] / 1e3, latencies[latency_count-1] / 1e3);
+    return (latency_count==(long)job.conns * job.messages) ? 0 : 1;
+}
@@ -1,5 +1,9 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <locale.h>
 #include "lightcjson.h"
 
 typedef char *((*functiontype3)(const char *, char *, int));
@@ -24,8 +28,39 @@ int test_jsonGetKeyValue();
 int t_jsonGetKeyValue(char *input, char *expect_key, char *expect_value, int expect_null);
 
 int test_jsonAppendItem();
+int test_jsonBuild();
 int test_jsonStreamKeyValues();
 
+int test_jsonTokenize();
+int test_jsonStream();
+int test_jsonN();
+int test_jsonSpan();
+int test_jsonExtractMany();
+int test_jsonSchema();
+int test_jsonValue();
+int test_jsonQuery();
+int test_jsonList();
+int test_jsonObject();
+int test_jsonStats();
+int test_jsonValidate();
+int test_jsonDom();
+int test_jsonBin();
+int test_jsonMinify();
+int test_jsonProject();
+int test_jsonSplitArray();
+int test_jsonSax();
+int t_jsonValidate(char *json, int expect_valid, int expect_offset);
+int t_jsonMinifyWrite(void *ctx, const char *data, size_t len);
+int t_jsonProject(char *json, int deny, int step, char *expected, char *name);
+int t_jsonSplitElement(void *ctx, const char *json, const jsonSpan *span);
+int t_jsonSaxEvent(void *ctx, const jsonEvent *event);
+int t_jsonSaxStop(void *ctx, const jsonEvent *event);
+int t_jsonSax(char *json, size_t step, char *out);
+void t_jsonObjectWalk(jsonCursor *cursor, int is_object, char *path, char *out);
+int t_jsonSpan(jsonSpan *span, int offset, int len, jsonType type, char *name);
+int t_jsonStream(char *json, int ring_size, char *expected);
+int t_jsonTokenExtract(char *input, char *key_name, char *expected, int expect_null);
+
 int expect_num(int is, int expect, char *name);
 int expect_str(char *is, char *expect, char *name);
 
@@ -39,8 +74,27 @@ int main() {
     fail += test_jsonEscape();
     fail += test_jsonQuote();
     fail += test_jsonAppendItem();
+    fail += test_jsonBuild();
     fail += test_jsonGetKeyValue();
     fail += test_jsonStreamKeyValues();
+    fail += test_jsonTokenize();
+    fail += test_jsonStream();
+    fail += test_jsonN();
+    fail += test_jsonSpan();
+    fail += test_jsonExtractMany();
+    fail += test_jsonSchema();
+    fail += test_jsonValue();
+    fail += test_jsonQuery();
+    fail += test_jsonList();
+    fail += test_jsonObject();
+    fail += test_jsonStats();
+    fail += test_jsonValidate();
+    fail += test_jsonDom();
+    fail += test_jsonBin();
+    fail += test_jsonMinify();
+    fail += test_jsonProject();
+    fail += test_jsonSplitArray();
+    fail += test_jsonSax();
 
     printf("\nTests failed: %d\n", fail);
     return 0;
@@ -262,7 +316,8 @@ int expect_str(char *is, char *expect, char *name) {
 
 
 int test_jsonGetKeyValue() {
-    int run=0, fail=0;
+    int run=0, fail=0, i;
+    char input[1300], name[1101];
 
     run++; fail+=t_jsonGetKeyValue("", "", "", 1);
     run++; fail+=t_jsonGetKeyValue("abc", "", "", 1);
@@ -273,7 +328,22 @@ int test_jsonGetKeyValue() {
     run++; fail+=t_jsonGetKeyValue("\"k\":    1,", "k", "1", 0);
     run++; fail+=t_jsonGetKeyValue("\"k\":\"1\",", "k", "\"1\"", 0);
     run++; fail+=t_jsonGetKeyValue("\"k\":\"1\",\"c\":2", "k", "\"1\"", 0);
- 
+    run++; fail+=t_jsonGetKeyValue("\"k\\\"\\n\":{\"k\\\"\\n\":1}", "k\"\n", "{\"k\\\"\\n\":1}", 0);
+    run++; fail+=t_jsonGetKeyValue("\"k\":true}", "k", "true", 0);
+    run++; fail+=t_jsonGetKeyValue("\"k\": null ,", "k", "null", 0);
+    run++; fail+=t_jsonGetKeyValue("\"k\":nul}", "", "", 1);
+    run++; fail+=t_jsonGetKeyValue("\"k\":xyz,\"c\":2", "", "", 1);
+
+    // room is checked on the decoded name: 600 escapes fit in 1024
+    memset(name, 'k', 1100);
+    sprintf(input, "\"%.1100s\":1", name);
+    run++; fail+=t_jsonGetKeyValue(input, "", "", 1);
+    for (i=0; i<600; i++) memcpy(input+1+i*2, "\\n", 2);
+    sprintf(input+1+600*2, "\":1");
+    memset(name, '\n', 600);
+    name[600] = '\0';
+    run++; fail+=t_jsonGetKeyValue(input, name, "1", 0);
+
     printf("Tests run: %d, failed: %d\n\n", run, fail);
     return fail;
 
@@ -334,6 +404,67 @@ int test_jsonAppendItem() {
 }
 
 
+int test_jsonBuild() {
+    int run=0, fail=0;
+    char buff[1024];
+    jsonBuilder b;
+
+    printf("jsonBuild():\n");
+    jsonBuildInit(&b, buff, sizeof(buff));
+    jsonBuildObject(&b, NULL);
+    jsonBuildString(&b, "s", "a\"b");
+    jsonBuildInt(&b, "i", -1234567890123LL);
+    jsonBuildInt(&b, "min", INT64_MIN);
+    jsonBuildDouble(&b, "d", 0.1);
+    jsonBuildDouble(&b, "e", 1e300*1e300);
+    jsonBuildBool(&b, "t", 1);
+    jsonBuildNull(&b, "n");
+    jsonBuildArray(&b, "l");
+    jsonBuildInt(&b, NULL, 1);
+    jsonBuildObject(&b, NULL);
+    jsonBuildEnd(&b);
+    jsonBuildRaw(&b, NULL, "[2,3]");
+    jsonBuildEnd(&b);
+    run++; fail+=expect_num(jsonBuildEnd(&b), 1, "jsonBuildEnd");
+    run++; fail+=expect_str(buff, "{\"s\":\"a\\\"b\",\"i\":-1234567890123,"
+        "\"min\":-9223372036854775808,\"d\":0.1,\"e\":null,\"t\":true,\"n\":null,"
+        "\"l\":[1,{},[2,3]]}", "jsonBuild");
+    run++; fail+=expect_num(b.len, strlen(buff), "len");
+    run++; fail+=expect_num(jsonBuildEnd(&b), 0, "jsonBuildEnd unbalanced");
+
+    // overflow keeps what fit and sets error
+    jsonBuildInit(&b, buff, 10);
+    jsonBuildObject(&b, NULL);
+    run++; fail+=expect_num(jsonBuildString(&b, "key", "value"), 0, "overflow");
+    run++; fail+=expect_num(b.error, 1, "error");
+    run++; fail+=expect_num(jsonBuildEnd(&b), 0, "after error");
+    run++; fail+=expect_num(strlen(buff)<10, 1, "terminated");
+    run++; fail+=expect_num((int)strlen(buff), b.len, "terminated at len");
+    jsonBuildInit(&b, buff, 10);
+    run++; fail+=expect_num(jsonBuildString(&b, NULL, "long value"), 0, "value overflow");
+    run++; fail+=expect_num((int)strlen(buff), b.len, "value terminated at len");
+
+    // doubles that need 17 digits, and '.' in a comma locale where there is one
+    jsonBuildInit(&b, buff, sizeof(buff));
+    jsonBuildDouble(&b, NULL, 0.1+0.2);
+    run++; fail+=expect_str(buff, "0.30000000000000004", "17 digits");
+    if (setlocale(LC_NUMERIC, "de_DE.UTF-8") || setlocale(LC_NUMERIC, "fr_FR.UTF-8")) {
+        char bin[64];
+        jsonSpan root;
+        jsonBuildInit(&b, buff, sizeof(buff));
+        jsonBuildDouble(&b, NULL, 1.5);
+        run++; fail+=expect_str(buff, "1.5", "comma locale");
+        jsonBinRoot(bin, jsonBinEncode("[2.5e-7]", 8, bin, sizeof(bin)), &root);
+        jsonBinDecode(bin, &root, buff, sizeof(buff));
+        run++; fail+=expect_str(buff, "[2.5e-07]", "comma locale binary");
+        setlocale(LC_NUMERIC, "C");
+    }
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+
 //char *jsonEscape(const char *input, char *dest, int size);
 //char *jsonUnescape(const char *json, char *dest, int size);
 int test_jsonEscape() {
@@ -343,10 +474,39 @@ int test_jsonEscape() {
     run++; fail+=t_func("a", "a", &jsonEscape, "jsonEscape");
     run++; fail+=t_func("abc", "abc", &jsonEscape, "jsonEscape");
     run++; fail+=t_func("a\"bc", "a\\\"bc", &jsonEscape, "jsonEscape");
+    run++; fail+=t_func("a\\b/c", "a\\\\b/c", &jsonEscape, "jsonEscape");
+    run++; fail+=t_func("\b\f\n\r\t", "\\b\\f\\n\\r\\t", &jsonEscape, "jsonEscape");
+    run++; fail+=t_func("a\x01\x1f\x7f", "a\\u0001\\u001f\x7f", &jsonEscape, "jsonEscape");
+    run++; fail+=t_func("a line that is longer than one block\nwith \"quotes\" in it", 
+        "a line that is longer than one block\\nwith \\\"quotes\\\" in it", &jsonEscape, "jsonEscape");
+    {
+        char buff[16];
+        run++; fail+=expect_num(jsonEscapeTo("a\"b\n", 4, NULL, 0), 6, "jsonEscapeTo(measure)");
+        run++; fail+=expect_num(jsonEscapeTo("a\"b\n", 4, buff, sizeof(buff)), 6, "jsonEscapeTo");
+        run++; fail+=expect_str(buff, "a\\\"b\\n", "jsonEscapeTo");
+        // cut short: the escape that does not fit is left out whole
+        run++; fail+=expect_num(jsonEscapeTo("ab\x01", 3, buff, 5), 8, "jsonEscapeTo(5)");
+        run++; fail+=expect_str(buff, "ab", "jsonEscapeTo(5)");
+    }
 
     run++; fail+=t_func("", "", &jsonUnescape, "jsonUnescape");
     run++; fail+=t_func("a\"bc", "a\"bc", &jsonUnescape, "jsonUnescape");
     run++; fail+=t_func("a\\\"bc", "a\"bc", &jsonUnescape, "jsonUnescape");
+    run++; fail+=t_func("a\\\\b\\/c", "a\\b/c", &jsonUnescape, "jsonUnescape");
+    run++; fail+=t_func("\\b\\f\\n\\r\\t", "\b\f\n\r\t", &jsonUnescape, "jsonUnescape");
+    run++; fail+=t_func("caf\\u00e9 \\u20AC", "caf\xc3\xa9 \xe2\x82\xac", &jsonUnescape, "jsonUnescape");
+    run++; fail+=t_func("\\ud83d\\ude00!", "\xf0\x9f\x98\x80!", &jsonUnescape, "jsonUnescape");
+    run++; fail+=t_func("\\ud83dx\\ude00", "\xef\xbf\xbdx\xef\xbf\xbd", &jsonUnescape, "jsonUnescape");
+    run++; fail+=t_func("\\u00zz\\x\\", "\\u00zz\\x\\", &jsonUnescape, "jsonUnescape");
+    {
+        char buff[32];
+        strcpy(buff, "a\\n\\u00e9\\ud83d\\ude00b");
+        run++; fail+=expect_str(jsonUnescape(buff, buff, sizeof(buff)), 
+            "a\n\xc3\xa9\xf0\x9f\x98\x80" "b", "jsonUnescape(in place)");
+        // bounded: a character that does not fit is left out whole
+        run++; fail+=expect_str(jsonUnescape("ab\\u20ac", buff, 5), "ab", "jsonUnescape(5)");
+        run++; fail+=expect_str(jsonUnescape("ab\\u20ac", buff, 6), "ab\xe2\x82\xac", "jsonUnescape(6)");
+    }
 
     printf("Tests run: %d, failed: %d\n\n", run, fail);
     return fail;
@@ -362,6 +522,7 @@ int test_jsonQuote() {
     run++; fail+=t_func("a", "\"a\"", &jsonQuote, "jsonQuote");
     run++; fail+=t_func("ab", "\"ab\"", &jsonQuote, "jsonQuote");
     run++; fail+=t_func("a\"b", "\"a\\\"b\"", &jsonQuote, "jsonQuote");
+    run++; fail+=t_func("a\tb", "\"a\\tb\"", &jsonQuote, "jsonQuote");
 
     run++; fail+=t_func("", "", &jsonUnquote, "jsonUnquote");
     run++; fail+=t_func("\"\"", "", &jsonUnquote, "jsonUnquote");
@@ -416,6 +577,13 @@ int test_jsonExtract() {
     run++; fail+=t_jsonExtract("\"key\":1-", "key", "1", 0);
     run++; fail+=t_jsonExtract("\"key\":1.", "key", "1.", 0);
     run++; fail+=t_jsonExtract("\"key\":.1", "key", "", 1);
+    run++; fail+=t_jsonExtract("\"key\":1e5,", "key", "1e5", 0);
+    run++; fail+=t_jsonExtract("\"key\":-2.5E-3}", "key", "-2.5E-3", 0);
+    run++; fail+=t_jsonExtract("\"key\":1e", "key", "1", 0);
+    run++; fail+=t_jsonExtract("\"key\":true", "key", "true", 0);
+    run++; fail+=t_jsonExtract("\"key\":false}", "key", "false", 0);
+    run++; fail+=t_jsonExtract("\"key\": null,", "key", "null", 0);
+    run++; fail+=t_jsonExtract("\"key\":nil", "key", "", 1);
     run++; fail+=t_jsonExtract("\"key\":\"\"", "key", "\"\"", 0);
     run++; fail+=t_jsonExtract("\"key\":\"a\"", "key", "\"a\"", 0);
     run++; fail+=t_jsonExtract("\"key\":\"ab\"", "key", "\"ab\"", 0);
@@ -431,6 +599,11 @@ int test_jsonExtract() {
     run++; fail+=t_jsonExtract("\"key\":[\"a\\\"b\"]", "key", "[\"a\\\"b\"]", 0);
     run++; fail+=t_jsonExtract("\"key\":{\"key\":1}", "key", "{\"key\":1}", 0);
     run++; fail+=t_jsonExtract("\"abc\":{\"def\":1}", "def", "1", 0);
+    run++; fail+=t_jsonExtract("\"key\":[\"a string longer than one block \\\"]\", {\"b\":[1,2]}], \"c\":1", "key", 
+        "[\"a string longer than one block \\\"]\", {\"b\":[1,2]}]", 0);
+    // a string ending in an escaped backslash is closed by the quote after it
+    run++; fail+=t_jsonExtract("\"key\":\"a\\\\\",\"b\":2", "key", "\"a\\\\\"", 0);
+    run++; fail+=t_jsonExtract("\"key\":[\"a\\\\\", \"]\"],\"b\":2", "key", "[\"a\\\\\", \"]\"]", 0);
  
     printf("Tests run: %d, failed: %d\n\n", run, fail);
     return fail;
@@ -552,6 +725,10 @@ int test_jsonIndexList() {
     run++;fail+=t_jsonIndexList("4,{1,2,3}", 1, "{1,2,3}", 0);
     run++;fail+=t_jsonIndexList("[a,b],{1,2,3}", 0, "[a,b]", 0);
     run++;fail+=t_jsonIndexList("[a,b],{1,2,3}", 1, "{1,2,3}", 0);
+    run++;fail+=t_jsonIndexList("[1, 2, 3], \"a string longer than one block\", {\"x\": [4, 5]} ", 2, "{\"x\": [4, 5]}", 0);
+    run++;fail+=t_jsonIndexList("\"a,b\", \"c]\", 3", 0, "\"a,b\"", 0);
+    run++;fail+=t_jsonIndexList("\"a,b\", \"c]\", 3", 2, "3", 0);
+    run++;fail+=t_jsonIndexList("[\"]\", \"[\"], 4", 1, "4", 0);
 
     printf("Tests run: %d, failed: %d\n\n", run, fail);
     return fail;
@@ -607,6 +784,10 @@ int test_jsonRemoveSpacing() {
     run++;fail+=t_jsonRemoveSpacing("{1,2,\t3}", "{1,2,3}");
     run++;fail+=t_jsonRemoveSpacing("{1,2,\r3}", "{1,2,3}");
     run++;fail+=t_jsonRemoveSpacing("{1,2,\n3}", "{1,2,3}");
+    run++;fail+=t_jsonRemoveSpacing("{ \"a long key name\" : [ 1, 2, 3, 4, 5, 6 ],\n  \"b\" : \"with \\\" and  spaces\" }", 
+        "{\"a long key name\":[1,2,3,4,5,6],\"b\":\"with \\\" and  spaces\"}");
+    run++;fail+=t_jsonRemoveSpacing("                                \"  32 spaces before and in string  \"  ", 
+        "\"  32 spaces before and in string  \"");
 
     printf("Tests run: %d, failed: %d\n\n", run, fail);
     return fail;
@@ -629,4 +810,935 @@ int t_jsonRemoveSpacing(char *input, char *expected) {
         printf("  FAILED: result value mismatch\n"); err++;
     }
     return err;
-}
\ No newline at end of file
+}
+
+int test_jsonTokenize() {
+    int run=0, fail=0;
+    jsonToken tok[32];
+    char buff[1024];
+    char *json = "{\"a\":1, \"b\":[1,\"x]\",{\"c\":null}], \"c\":true}";
+    int count, i;
+
+    printf("jsonTokenize(%s):\n", json);
+    count = jsonTokenize(json, tok, 32);
+    run++; fail+=expect_num(count, 12, "count");
+    run++; fail+=expect_num(tok[0].type, JSON_OBJECT, "tok[0].type");
+    run++; fail+=expect_num(tok[0].len, strlen(json), "tok[0].len");
+    run++; fail+=expect_num(tok[0].next, 12, "tok[0].next");
+    run++; fail+=expect_num(tok[1].is_key, 1, "tok[1].is_key");
+    run++; fail+=expect_num(tok[4].type, JSON_ARRAY, "tok[4].type");
+    run++; fail+=expect_num(tok[4].next, 10, "tok[4].next");
+    run++; fail+=expect_num(tok[6].type, JSON_STRING, "tok[6].type");
+    run++; fail+=expect_num(tok[6].is_key, 0, "tok[6].is_key");
+    run++; fail+=expect_num(tok[8].depth, 3, "tok[8].depth");
+    run++; fail+=expect_num(tok[9].type, JSON_NULL, "tok[9].type");
+    run++; fail+=expect_num(tok[11].type, JSON_TRUE, "tok[11].type");
+    run++; fail+=expect_num(jsonTokenize(json, tok, 3), -1, "overfill");
+
+    count = jsonTokenize(json, tok, 32);
+    run++; fail+=expect_str(jsonTokenExtract(json, tok, count, "c", buff, sizeof(buff)), 
+        "null", "jsonTokenExtract(c)");
+    i = jsonTokenFind(json, tok, count, 0, "c");
+    run++; fail+=expect_num(i, 11, "jsonTokenFind(0,c)");
+    i = jsonTokenChild(tok, count, 4, 1);
+    run++; fail+=expect_str(jsonTokenCopy(json, &tok[i], buff, sizeof(buff)), 
+        "\"x]\"", "jsonTokenChild(4,1)");
+    run++; fail+=expect_num(jsonTokenChild(tok, count, 4, 3), -1, "jsonTokenChild(4,3)");
+    run++; fail+=expect_num(jsonTokenChild(tok, count, 0, 1), 4, "jsonTokenChild(0,1)");
+
+    run++; fail+=expect_str(jsonTokenIndexList("1, [2,3] ,x", tok, 
+        jsonTokenize("1, [2,3] ,x", tok, 32), 1, buff, sizeof(buff)), "[2,3]", "jsonTokenIndexList(1)");
+    run++; fail+=(jsonTokenIndexList("1,2", tok, 
+        jsonTokenize("1,2", tok, 32), 2, buff, sizeof(buff))!=NULL);
+
+    json = "\"k\\\"y\":\"v\",\"z\":2";
+    count = jsonTokenize(json, tok, 32);
+    run++; fail+=expect_num(jsonTokenGetKeyValue(json, tok, count, 0, buff, buff+100, 100), 
+        1, "jsonTokenGetKeyValue");
+    run++; fail+=expect_str(buff, "k\"y", "key");
+    run++; fail+=expect_str(buff+100, "\"v\"", "value");
+    // keys decode the same as in jsonGetKeyValue
+    json = "\"a\\n\\u00e9\\ud83d\\ude00\":1";
+    count = jsonTokenize(json, tok, 32);
+    run++; fail+=expect_num(jsonTokenGetKeyValue(json, tok, count, 0, buff, buff+100, 100), 
+        1, "jsonTokenGetKeyValue escapes");
+    jsonGetKeyValue(json, buff+200, buff+300, 100);
+    run++; fail+=expect_str(buff, buff+200, "same key as jsonGetKeyValue");
+    run++; fail+=expect_str(buff, "a\n\xc3\xa9\xf0\x9f\x98\x80", "decoded key");
+    run++; fail+=expect_num(jsonTokenGetKeyValue(json, tok, count, 0, buff, buff+100, 4), 
+        0, "key out of room");
+
+    run++; fail+=t_jsonTokenExtract("", "key", "", 1);
+    run++; fail+=t_jsonTokenExtract("\"key\":", "key", "", 0);
+    run++; fail+=t_jsonTokenExtract("\"key\": ", "key", "", 0);
+    run++; fail+=t_jsonTokenExtract("\"key\":  123 ", "key", "123", 0);
+    run++; fail+=t_jsonTokenExtract("\"key\":-1", "key", "-1", 0);
+    run++; fail+=t_jsonTokenExtract("\"key\":\"a\\\"b\"", "key", "\"a\\\"b\"", 0);
+    run++; fail+=t_jsonTokenExtract("\"key\":[\"]\"]", "key", "[\"]\"]", 0);
+    run++; fail+=t_jsonTokenExtract("\"key\":{\"key\":1}", "key", "{\"key\":1}", 0);
+    run++; fail+=t_jsonTokenExtract("\"abc\":{\"def\":1}", "def", "1", 0);
+    run++; fail+=t_jsonTokenExtract("\"abc\":\"key\",\"key\":2", "key", "2", 0);
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int t_jsonTokenExtract(char *input, char *key_name, char *expected, int expect_null) {
+    jsonToken tok[64];
+    char buff_out[1024];
+    char *ptr;
+    int err = 0;
+    int count = jsonTokenize(input, tok, 64);
+
+    printf("jsonTokenExtract(%s,%s):", input, key_name);
+    ptr = jsonTokenExtract(input, tok, count, key_name, buff_out, sizeof(buff_out));
+    if (expect_null) {
+        printf("  is: %s - expected: %s\n", 
+            (ptr==NULL)?"NULL":"NON-NULL", "NULL");
+        if (ptr!=NULL) {
+            printf("  FAILED: result code mismatch\n"); err++;
+        }
+    } else {
+        printf("  is: %s - expected: %s\n", buff_out, expected);
+        if (ptr != buff_out) {
+            printf("  FAILED: result code mismatch\n"); err++;
+        }
+        if (strcmp(buff_out, expected)!=0) {
+            printf("  FAILED: result value mismatch\n"); err++;
+        }
+    }
+    return err;
+}
+
+
+int test_jsonStream() {
+    int run=0, fail=0;
+
+    run++; fail+=t_jsonStream("{\"key\":1}", 64, "key=1;");
+    run++; fail+=t_jsonStream("{\"key\":1", 64, "");
+    run++; fail+=t_jsonStream("{\"a\" : \"b\", \"c\":-1.5e3, \"d\":true,\"e\":null}", 64, 
+        "a=\"b\";c=-1.5e3;d=true;e=null;");
+    run++; fail+=t_jsonStream("{\"k\\\"y\":\"x\\\"y\"}", 64, "k\"y=\"x\\\"y\";");
+    run++; fail+=t_jsonStream("{\"c\": {\"w\":\"v\"},\"a\":[1,2],\"x\":nope,\"d\":2}", 64, 
+        "w=\"v\";d=2;");
+    run++; fail+=t_jsonStream("[\"a\",\"b\":1]", 64, "b=1;");
+    // ring buffer wraps many times
+    run++; fail+=t_jsonStream("{\"a\":1,\"bb\":22,\"ccc\":\"333\",\"dddd\":4444,\"e\":5}", 12, 
+        "a=1;bb=22;ccc=\"333\";dddd=4444;e=5;");
+    // pair larger than ring buffer
+    run++; fail+=t_jsonStream("{\"a\":1,\"longer_than_ring\":2}", 12, "a=1;!;");
+    // key larger than item size
+    run++; fail+=t_jsonStream("{\"a_key_longer_than_item_size_____\":1,\"b\":2}", 64, "!;b=2;");
+    // string larger than ring buffer, the key text in it is skipped with it
+    run++; fail+=t_jsonStream("{\"a\":\"0123456789 \\\"k\\\":1, \\\"m\\\\\\\":\\\"x\\\" 0123456789\",\"b\":2}", 16, 
+        "!;b=2;");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+// feed json in every chunk size, collect pairs as "key=value;", "!;" for -1
+int t_jsonStream(char *json, int ring_size, char *expected) {
+    char ring[256], key[32], value[32], out[1024];
+    jsonStream stream;
+    size_t len = strlen(json);
+    int chunk, ret, err = 0;
+
+    printf("jsonStream(%s, %d):", json, ring_size);
+    for (chunk=1; chunk<=len; chunk++) {
+        size_t done = 0;
+        out[0] = '\0';
+        jsonStreamInit(&stream, ring, ring_size);
+        while (done<len) {
+            size_t n = len-done;
+            if (n>chunk) n=chunk;
+            done += jsonStreamFeed(&stream, json+done, n);
+            while ((ret = jsonStreamNext(&stream, key, value, sizeof(key)))!=0) {
+                if (ret<0) {
+                    strcat(out, "!;");
+                } else {
+                    strcat(out, key); strcat(out, "="); strcat(out, value); strcat(out, ";");
+                }
+            }
+        }
+        if (strcmp(out, expected)!=0) {
+            printf("  chunk %d is: %s - expected: %s\n", chunk, out, expected);
+            printf("  FAILED: result value mismatch\n"); err++;
+            break;
+        }
+    }
+    if (!err) printf("  is: %s - expected: %s\n", out, expected);
+    return err;
+}
+
+
+// pointer+length variants must stop at len, whatever follows
+int test_jsonN() {
+    int run=0, fail=0;
+    char out[64];
+    char in[] = " \"key\": [1, \"a\\\"b\"] ,\"num\":123456 ";
+    jsonToken tok[16];
+
+    printf("jsonXxxN():\n");
+    run++; fail+=expect_str(jsonTrimN(in, 8, out), "\"key\":", "jsonTrimN");
+    run++; fail+=expect_str(jsonRemoveSpacingN(in, 14, out), "\"key\":[1,\"a", "jsonRemoveSpacingN");
+    run++; fail+=expect_str(jsonExtractN(in, strlen(in)-4, "num", out, sizeof(out)), 
+        "123", "jsonExtractN");
+    run++; fail+=(jsonExtractN(in, 5, "key", out, sizeof(out))!=NULL);
+    run++; fail+=expect_str(jsonExtractN(in, 8, "key", out, sizeof(out)), "", "jsonExtractN cut");
+    run++; fail+=expect_str(jsonExtractN(in, 10, "key", out, sizeof(out)), "[1", "jsonExtractN cut");
+    run++; fail+=expect_str(jsonIndexListN("1, 22,333", 5, 1, out, sizeof(out)), "22", "jsonIndexListN");
+    run++; fail+=expect_str(jsonEscapeN("a\"b\"c", 3, out, sizeof(out)), "a\\\"b", "jsonEscapeN");
+    run++; fail+=expect_str(jsonUnescapeN("a\\\"b", 2, out, sizeof(out)), "a\\", "jsonUnescapeN");
+    run++; fail+=expect_num(jsonTokenizeN(in, 14, tok, 16), 4, "jsonTokenizeN");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+
+int test_jsonSpan() {
+    int run=0, fail=0;
+    char *json = "{\"a\": \"x\", \"b\":[1, {\"c\":2}], \"d\":-1.5 , \"e\":}";
+    char *list = " 1, \"two\" , [3] ,{}, x";
+    char out[16];
+    jsonSpan span;
+
+    printf("jsonExtractSpan(%s):\n", json);
+    run++; fail+=expect_num(jsonExtractSpan(json, strlen(json), "a", &span), 1, "a");
+    run++; fail+=t_jsonSpan(&span, 6, 3, JSON_STRING, "a");
+    run++; fail+=expect_num(jsonExtractSpan(json, strlen(json), "b", &span), 1, "b");
+    run++; fail+=t_jsonSpan(&span, 15, 12, JSON_ARRAY, "b");
+    run++; fail+=expect_num(jsonExtractSpan(json, strlen(json), "c", &span), 1, "c");
+    run++; fail+=t_jsonSpan(&span, 24, 1, JSON_NUMBER, "c");
+    run++; fail+=expect_num(jsonExtractSpan(json, strlen(json), "d", &span), 1, "d");
+    run++; fail+=t_jsonSpan(&span, 33, 4, JSON_NUMBER, "d");
+    run++; fail+=expect_num(jsonExtractSpan(json, strlen(json), "e", &span), 0, "e");
+    run++; fail+=expect_num(jsonExtractSpan(json, strlen(json), "f", &span), 0, "f");
+    run++; fail+=expect_num(jsonExtractSpan("\"k\": ", 5, "k", &span), 1, "k");
+    run++; fail+=t_jsonSpan(&span, 5, 0, JSON_NONE, "k");
+
+    printf("jsonIndexListSpan(%s):\n", list);
+    run++; fail+=expect_num(jsonIndexListSpan(list, strlen(list), 0, &span), 1, "0");
+    run++; fail+=t_jsonSpan(&span, 1, 1, JSON_NUMBER, "0");
+    run++; fail+=expect_num(jsonIndexListSpan(list, strlen(list), 1, &span), 1, "1");
+    run++; fail+=t_jsonSpan(&span, 4, 5, JSON_STRING, "1");
+    run++; fail+=expect_str(jsonSpanCopy(list, &span, out, sizeof(out)), "\"two\"", "jsonSpanCopy");
+    run++; fail+=expect_str(jsonSpanCopy(list, &span, out, 3), "\"t", "jsonSpanCopy(3)");
+    strcpy(out, "x");
+    run++; fail+=expect_str(jsonSpanCopy(list, &span, out, 0), "x", "jsonSpanCopy(0) leaves dest");
+    run++; fail+=expect_str(jsonSpanCopy(list, &span, out, -1), "x", "jsonSpanCopy(-1) leaves dest");
+    run++; fail+=expect_num(jsonExtractN(list, strlen(list), "none", out, 0)==NULL, 1, "not found, size 0");
+    run++; fail+=expect_str(out, "x", "not found leaves dest");
+    run++; fail+=expect_num(jsonIndexListSpan(list, strlen(list), 2, &span), 1, "2");
+    run++; fail+=t_jsonSpan(&span, 12, 3, JSON_ARRAY, "2");
+    run++; fail+=expect_num(jsonIndexListSpan(list, strlen(list), 3, &span), 1, "3");
+    run++; fail+=t_jsonSpan(&span, 17, 2, JSON_OBJECT, "3");
+    run++; fail+=expect_num(jsonIndexListSpan(list, strlen(list), 4, &span), 1, "4");
+    run++; fail+=t_jsonSpan(&span, 21, 1, JSON_NONE, "4");
+    run++; fail+=expect_num(jsonIndexListSpan(list, strlen(list), 5, &span), 0, "5");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int t_jsonSpan(jsonSpan *span, int offset, int len, jsonType type, char *name) {
+    int err = 0;
+    printf("  %s: offset=%d len=%d type=%d\n", name, (int)span->offset, (int)span->len, span->type);
+    err += expect_num(span->offset, offset, "offset");
+    err += expect_num(span->len, len, "len");
+    err += expect_num(span->type, type, "type");
+    return err;
+}
+
+
+int test_jsonExtractMany() {
+    int run=0, fail=0;
+    char *json = "{\"id\":17, \"name\":\"temp\", \"note\":\"\\\"unit\\\":\", "
+        "\"tags\":[\"a\",\"b\"], \"pos\":{\"x\":1.5, \"unit\":\"m\"}, \"ok\":true}";
+    const char *keys[] = { "ok", "unit", "id", "missing", "tags", "x", "id" };
+    jsonSpan spans[7];
+    char out[64];
+
+    printf("jsonExtractMany(%s):\n", json);
+    run++; fail+=expect_num(jsonExtractMany(json, strlen(json), keys, spans, 7), 6, "found");
+    run++; fail+=expect_str(jsonSpanCopy(json, &spans[0], out, sizeof(out)), "true", "ok");
+    run++; fail+=expect_num(spans[0].type, JSON_TRUE, "ok type");
+    run++; fail+=expect_str(jsonSpanCopy(json, &spans[1], out, sizeof(out)), "\"m\"", "unit");
+    run++; fail+=expect_str(jsonSpanCopy(json, &spans[2], out, sizeof(out)), "17", "id");
+    run++; fail+=expect_num(spans[3].type, JSON_NONE, "missing");
+    run++; fail+=expect_str(jsonSpanCopy(json, &spans[4], out, sizeof(out)), "[\"a\",\"b\"]", "tags");
+    run++; fail+=expect_str(jsonSpanCopy(json, &spans[5], out, sizeof(out)), "1.5", "x");
+    run++; fail+=expect_str(jsonSpanCopy(json, &spans[6], out, sizeof(out)), "17", "id again");
+    run++; fail+=expect_num(jsonExtractMany("", 0, keys, spans, 7), 0, "empty");
+    run++; fail+=expect_num(jsonExtractMany(json, strlen(json), keys, spans, 0), 0, "no keys");
+    run++; fail+=expect_num(jsonExtractMany(json, strlen(json), keys, spans, JSON_MANY_MAX_KEYS+1), -1, "too many keys");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+
+typedef struct {
+    int id;
+    int64_t ts;
+    double temp;
+    int ok;
+    char name[8];
+} telemetry;
+
+int test_jsonSchema() {
+    int run=0, fail=0;
+    static const jsonField fields[] = {
+        JSON_FIELD(telemetry, id, JSON_FIELD_INT),
+        JSON_FIELD(telemetry, ts, JSON_FIELD_INT64),
+        JSON_FIELD(telemetry, temp, JSON_FIELD_DOUBLE),
+        JSON_FIELD(telemetry, ok, JSON_FIELD_BOOL),
+        JSON_FIELD_NAMED("device-name", telemetry, name, JSON_FIELD_STRING),
+    };
+    jsonSchema schema;
+    telemetry t;
+    char *json = "{ \"ts\": 1700000000123, \"extra\": {\"id\": 9}, \"id\":42,"
+        "\"temp\":-2.5e1, \"name\":\"x\", \"device-name\":\"a\\\"b\\\"c1234\", \"ok\":true }";
+
+    printf("jsonSchemaDecode(%s):\n", json);
+    run++; fail+=expect_num(jsonSchemaCompile(&schema, fields, 5), 1, "compile");
+    memset(&t, 0, sizeof(t));
+    run++; fail+=expect_num(jsonSchemaDecode(&schema, json, strlen(json), &t), 5, "set");
+    run++; fail+=expect_num(t.id, 42, "id");
+    run++; fail+=expect_num(t.ts==1700000000123LL, 1, "ts");
+    run++; fail+=expect_num(t.temp==-25.0, 1, "temp");
+    run++; fail+=expect_num(t.ok, 1, "ok");
+    run++; fail+=expect_str(t.name, "a\"b\"c12", "name");
+
+    // wrong types and nulls are skipped
+    json = "{\"id\":\"7\",\"ok\":null,\"temp\":3,\"ts\":1.9}";
+    run++; fail+=expect_num(jsonSchemaDecode(&schema, json, strlen(json), &t), 2, "set");
+    run++; fail+=expect_num(t.id, 42, "id kept");
+    run++; fail+=expect_num(t.temp==3.0, 1, "temp int");
+    run++; fail+=expect_num(t.ts==1, 1, "ts cut");
+    run++; fail+=expect_num(jsonSchemaDecode(&schema, "[1]", 3, &t), -1, "not a struct");
+    run++; fail+=expect_num(jsonSchemaDecode(&schema, "{\"id\":1", 8, &t), -1, "unterminated");
+    run++; fail+=expect_num(jsonSchemaDecode(&schema, "{}", 2, &t), 0, "empty");
+
+    static const jsonField twice[] = {
+        JSON_FIELD(telemetry, id, JSON_FIELD_INT),
+        JSON_FIELD_NAMED("id", telemetry, ts, JSON_FIELD_INT64),
+    };
+    run++; fail+=expect_num(jsonSchemaCompile(&schema, twice, 2), 0, "duplicate names");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int test_jsonValue() {
+    int run=0, fail=0;
+    char *json = "{\"n\":-42, \"d\":6.02214076e23, \"s\":\"x\", \"t\":true, \"f\":false, "
+        "\"z\":null, \"big\":1e300, \"tiny\":5e-324, \"min\":-9223372036854775808}";
+    jsonValue value;
+    int64_t num;
+    double real;
+    int flag;
+
+    printf("jsonExtractValue(%s):\n", json);
+    run++; fail+=expect_num(jsonExtractValue(json, strlen(json), "n", &value), JSON_NUMBER, "n type");
+    run++; fail+=expect_num(value.is_int && (value.int_value==-42), 1, "n int");
+    run++; fail+=expect_num(value.double_value==-42.0, 1, "n double");
+    run++; fail+=expect_num(jsonExtractValue(json, strlen(json), "d", &value), JSON_NUMBER, "d type");
+    run++; fail+=expect_num(!value.is_int && (value.double_value==6.02214076e23), 1, "d double");
+    run++; fail+=expect_num(jsonExtractValue(json, strlen(json), "s", &value), JSON_STRING, "s type");
+    run++; fail+=expect_num((int)value.span.len, 3, "s span");
+    run++; fail+=expect_num(jsonExtractValue(json, strlen(json), "z", &value), JSON_NULL, "z type");
+    run++; fail+=expect_num(jsonExtractValue(json, strlen(json), "q", &value), JSON_NONE, "missing");
+
+    run++; fail+=expect_num(jsonExtractBool(json, "t", &flag) && flag, 1, "t");
+    run++; fail+=expect_num(jsonExtractBool(json, "f", &flag) && !flag, 1, "f");
+    run++; fail+=expect_num(jsonExtractBool(json, "n", &flag), 0, "n not bool");
+    run++; fail+=expect_num(jsonExtractInt64(json, "min", &num) && (num==INT64_MIN), 1, "min");
+    run++; fail+=expect_num(jsonExtractInt64(json, "d", &num), 0, "d out of range");
+    run++; fail+=expect_num(jsonExtractDouble(json, "big", &real) && (real==1e300), 1, "big");
+    run++; fail+=expect_num(jsonExtractDouble(json, "tiny", &real) && (real==5e-324), 1, "tiny");
+    run++; fail+=expect_num(jsonExtractDouble(json, "s", &real), 0, "s not number");
+
+    // rounding: halfway cases and long mantissas
+    run++; fail+=expect_num(jsonParseDouble("9007199254740993", 16, &real) && 
+        (real==9007199254740992.0), 1, "round to even");
+    run++; fail+=expect_num(jsonParseDouble("2.2250738585072011e-308", 23, &real) && 
+        (real==2.2250738585072011e-308), 1, "subnormal edge");
+    run++; fail+=expect_num(jsonParseDouble("0.1000000000000000000000000001", 29, &real) && 
+        (real==0.1), 1, "long mantissa");
+    // w and w+1 round apart: the C library decides, with '.' in any locale
+    run++; fail+=expect_num(jsonParseDouble("9007199254740993.000001", 23, &real) && 
+        (real==9007199254740994.0), 1, "undecided");
+    run++; fail+=expect_num(jsonParseDouble("-9007199254740993000001e-6", 26, &real) && 
+        (real==-9007199254740994.0), 1, "undecided exponent");
+    run++; fail+=expect_num(jsonParseDouble("1.", 2, &real), 0, "1.");
+    run++; fail+=expect_num(jsonParseDouble("01", 2, &real), 0, "01");
+    run++; fail+=expect_num(jsonParseInt64("9223372036854775808", 19, &num), 0, "int overflow");
+    run++; fail+=expect_num(jsonParseInt64("1e3", 3, &num), 0, "int exponent");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int test_jsonQuery() {
+    int run=0, fail=0;
+    char *json = "{\"c\":0, \"a\": {\"x\":{\"c\":1}, \"b\": [10, \"]\", {\"c\":true}, [4, {\"c\":\"d\"}]]},"
+        " \"a/b\":5, \"m~n\":6, \"e\":[]}";
+    char out[64];
+    jsonSpan span;
+
+    printf("jsonQuery(%s):\n", json);
+    run++; fail+=expect_str(jsonQuery(json, "c", out, sizeof(out)), "0", "c");
+    run++; fail+=expect_str(jsonQuery(json, "a.b[0]", out, sizeof(out)), "10", "a.b[0]");
+    run++; fail+=expect_str(jsonQuery(json, "a.b[1]", out, sizeof(out)), "\"]\"", "a.b[1]");
+    run++; fail+=expect_str(jsonQuery(json, "a.b[2].c", out, sizeof(out)), "true", "a.b[2].c");
+    run++; fail+=expect_str(jsonQuery(json, "a.b[3][1].c", out, sizeof(out)), "\"d\"", "a.b[3][1].c");
+    run++; fail+=expect_str(jsonQuery(json, "a.x", out, sizeof(out)), "{\"c\":1}", "a.x");
+    run++; fail+=expect_str(jsonQuery("[1,[2,3]]", "[1][0]", out, sizeof(out)), "2", "[1][0]");
+    // JSON Pointer
+    run++; fail+=expect_str(jsonQuery(json, "/a/b/3/1/c", out, sizeof(out)), "\"d\"", "/a/b/3/1/c");
+    run++; fail+=expect_str(jsonQuery(json, "/a~1b", out, sizeof(out)), "5", "/a~1b");
+    run++; fail+=expect_str(jsonQuery(json, "/m~0n", out, sizeof(out)), "6", "/m~0n");
+    // keys only match at their own level
+    run++; fail+=expect_num(jsonQuery(json, "a.c", out, sizeof(out))==NULL, 1, "a.c");
+    run++; fail+=expect_num(jsonQuery(json, "a.b[4]", out, sizeof(out))==NULL, 1, "a.b[4]");
+    run++; fail+=expect_num(jsonQuery(json, "e[0]", out, sizeof(out))==NULL, 1, "e[0]");
+    run++; fail+=expect_num(jsonQuery(json, "a[0]", out, sizeof(out))==NULL, 1, "a[0]");
+    run++; fail+=expect_num(jsonQuery(json, "a.b[x]", out, sizeof(out))==NULL, 1, "a.b[x]");
+    // an empty key can only be named by a pointer
+    run++; fail+=expect_num(jsonQuery("{\"\":{\"\":1}}", "a..b", out, sizeof(out))==NULL, 1, "a..b");
+    run++; fail+=expect_num(jsonQuery("{\"\":1}", ".", out, sizeof(out))==NULL, 1, ".");
+    run++; fail+=expect_num(jsonQuery(json, "a.", out, sizeof(out))==NULL, 1, "a.");
+    run++; fail+=expect_num(jsonQuery(json, "a.[0]", out, sizeof(out))==NULL, 1, "a.[0]");
+    run++; fail+=expect_str(jsonQuery("{\"\":{\"\":1}}", "//", out, sizeof(out)), "1", "//");
+    run++; fail+=expect_num(jsonQuerySpan(json, strlen(json), "", &span), 1, "whole");
+    run++; fail+=expect_num((int)span.len, (int)strlen(json), "whole len");
+    run++; fail+=expect_num(jsonQuerySpan(json, strlen(json), "a.b", &span), 1, "a.b span");
+    run++; fail+=expect_num(span.type, JSON_ARRAY, "a.b type");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int test_jsonList() {
+    int run=0, fail=0;
+    char *json = " [1, \"a,]b\" , [2,[3]], {\"k\":\"}\"}, true ] ";
+    char *expected[] = { "1", "\"a,]b\"", "[2,[3]]", "{\"k\":\"}\"}", "true" };
+    char out[64];
+    char big[8192];
+    jsonCursor cursor;
+    jsonSpan span;
+    int i, len;
+
+    printf("jsonListNext(%s):\n", json);
+    run++; fail+=expect_num(jsonListInit(&cursor, json, strlen(json)), 1, "init");
+    for (i=0; i<5; i++) {
+        run++; fail+=expect_str(jsonListNextItem(&cursor, out, sizeof(out)), expected[i], "item");
+    }
+    run++; fail+=expect_num(jsonListNext(&cursor, &span), 0, "end");
+    run++; fail+=expect_num(jsonListNext(&cursor, &span), 0, "still end");
+    run++; fail+=expect_num(cursor.count, 5, "count");
+    jsonListInit(&cursor, json, strlen(json));
+    cursor.walk = 1;
+    for (i=0; i<5; i++) {
+        run++; fail+=expect_str(jsonListNextItem(&cursor, out, sizeof(out)), expected[i], "open item");
+    }
+    run++; fail+=expect_num(jsonListNext(&cursor, &span), 0, "open end");
+    run++; fail+=expect_num(jsonListInit(&cursor, " [ ]", 4), 1, "empty");
+    run++; fail+=expect_num(jsonListNext(&cursor, &span), 0, "empty end");
+    run++; fail+=expect_num(jsonListInit(&cursor, "{}", 2), 0, "not a list");
+    run++; fail+=expect_num(jsonListNext(&cursor, &span), 0, "not a list end");
+
+    // one pass over a long list
+    len = sprintf(big, "[");
+    for (i=0; i<1000; i++) len += sprintf(big+len, "%s%d", (i) ? "," : "", i);
+    len += sprintf(big+len, "]");
+    jsonListInit(&cursor, big, len);
+    while (jsonListNext(&cursor, &span)) ;
+    run++; fail+=expect_num(cursor.count, 1000, "long count");
+    run++; fail+=expect_str(jsonSpanCopy(big, &span, out, sizeof(out)), "999", "long last");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+// appends path=value; for every scalar below cursor
+void t_jsonObjectWalk(jsonCursor *cursor, int is_object, char *path, char *out) {
+    jsonSpan key, value;
+    jsonCursor child;
+    char *path_end = path + strlen(path);
+    int index = 0;
+
+    while ((is_object) ? jsonObjectNext(cursor, &key, &value) : jsonListNext(cursor, &value)) {
+        if (is_object) sprintf(path_end, ".%.*s", (int)key.len, cursor->json + key.offset);
+        else sprintf(path_end, "[%d]", index++);
+        if (jsonCursorEnter(cursor, &value, &child)) {
+            t_jsonObjectWalk(&child, value.type==JSON_OBJECT, path, out);
+        } else {
+            sprintf(out + strlen(out), "%s=%.*s;", path, (int)value.len, cursor->json + value.offset);
+        }
+    }
+    *path_end = '\0';
+}
+
+int test_jsonObject() {
+    int run=0, fail=0;
+    char *json = "{ \"a\": 1, \"b\" : {\"c\":\"}\", \"d\":[true, {\"e\":null}, []]}, \"f\":{}, \"g\":-2.5 }";
+    char path[256] = "", out[512] = "";
+    jsonCursor cursor, child;
+    jsonSpan key, value;
+
+    printf("jsonObjectNext(%s):\n", json);
+    run++; fail+=expect_num(jsonObjectInit(&cursor, json, strlen(json)), 1, "init");
+    t_jsonObjectWalk(&cursor, 1, path, out);
+    run++; fail+=expect_str(out, ".a=1;.b.c=\"}\";.b.d[0]=true;.b.d[1].e=null;.g=-2.5;", "walk");
+    run++; fail+=expect_num(cursor.count, 4, "count");
+    // members returned open: the same walk in one pass
+    out[0] = '\0';
+    jsonObjectInit(&cursor, json, strlen(json));
+    cursor.walk = 1;
+    t_jsonObjectWalk(&cursor, 1, path, out);
+    run++; fail+=expect_str(out, ".a=1;.b.c=\"}\";.b.d[0]=true;.b.d[1].e=null;.g=-2.5;", "open walk");
+    run++; fail+=expect_num(cursor.count, 4, "open count");
+
+    run++; fail+=expect_num(jsonObjectInit(&cursor, json, strlen(json)), 1, "init");
+    cursor.walk = 1;
+    run++; fail+=expect_num(jsonObjectNext(&cursor, &key, &value), 1, "a");
+    run++; fail+=expect_num(jsonObjectNext(&cursor, &key, &value), 1, "b");
+    run++; fail+=expect_num(value.type, JSON_OBJECT, "b type");
+    run++; fail+=expect_num((int)key.len, 1, "b key");
+    // left after one member, the parent still skips the rest of it
+    run++; fail+=expect_num(jsonCursorEnter(&cursor, &value, &child), 1, "enter b");
+    run++; fail+=expect_num(jsonObjectNext(&child, &key, &value), 1, "b.c");
+    run++; fail+=expect_num(jsonObjectNext(&cursor, &key, &value), 1, "f");
+    run++; fail+=expect_str(jsonSpanCopy(json, &key, path, sizeof(path)), "f", "f key");
+    run++; fail+=expect_num(jsonObjectNext(&cursor, &key, &value), 1, "g");
+    run++; fail+=expect_str(jsonSpanCopy(json, &value, path, sizeof(path)), "-2.5", "g value");
+    run++; fail+=expect_num(jsonObjectInit(&cursor, "[1]", 3), 0, "not an object");
+    run++; fail+=expect_num(jsonObjectInit(&cursor, "{\"a\" 1}", 8), 1, "broken");
+    run++; fail+=expect_num(jsonObjectNext(&cursor, &key, &value), 0, "broken next");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int test_jsonStats() {
+    int run=0, fail=0;
+    char buffer[64] = "", dest[16];
+    int last_offset;
+    jsonStats stats;
+
+    printf("jsonStatsSnapshot:\n");
+    jsonStatsReset();
+    jsonExtract("{\"a\":\"0123456789\",\"b\":2}", "b", dest, sizeof(dest));
+    jsonExtract("{\"a\":\"0123456789\"}", "a", dest, 4);
+    jsonStreamKeyValues("{\"a\":[1],\"b\":2}", buffer, sizeof(buffer), 0, &last_offset);
+    jsonStatsSnapshot(&stats);
+#ifdef LIGHTCJSON_STATS
+    run++; fail+=expect_num(stats.strlen_calls>=3, 1, "strlen_calls");
+    run++; fail+=expect_num(stats.key_searches>=2, 1, "key_searches");
+    run++; fail+=expect_num(stats.bytes_scanned>0, 1, "bytes_scanned");
+    run++; fail+=expect_num((int)stats.bytes_copied, 1+3+15, "bytes_copied");
+    run++; fail+=expect_num((int)stats.stream_restarts, 1, "stream_restarts");
+    run++; fail+=expect_num((int)stats.overfills, 0, "overfills");
+    jsonTokenize("[1,2,3]", NULL, 0);
+    jsonStatsSnapshot(&stats);
+    run++; fail+=expect_num((int)stats.overfills, 1, "overfills after tokenize");
+    jsonStatsReset();
+    jsonStatsSnapshot(&stats);
+    run++; fail+=expect_num((int)stats.strlen_calls, 0, "reset");
+#else
+    run++; fail+=expect_num((int)(stats.strlen_calls + stats.bytes_scanned + 
+        stats.bytes_copied + stats.overfills), 0, "off: all zero");
+#endif
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int t_jsonValidate(char *json, int expect_valid, int expect_offset) {
+    size_t offset = 0;
+    int valid = jsonValidate(json, strlen(json), &offset);
+    printf("jsonValidate(%s): %d@%d - expected: %d@%d", json, valid, (int)offset, 
+        expect_valid, expect_offset);
+    if ((valid!=expect_valid) || (!valid && ((int)offset!=expect_offset))) {
+        printf(" FAIL\n"); return 1;
+    }
+    printf("\n");
+    return 0;
+}
+
+int test_jsonValidate() {
+    int run=0, fail=0;
+    char *list = "1, \"a,b\" , [2,{\"c\":3}], \"\\\"x\"";
+    char *json = "{\"s\":\"\\\"k\\\":0\", \"k\" : [true, null], \"x\":\"k\"}";
+    jsonSpan span;
+
+    run++; fail+=t_jsonValidate("{\"a\":[1,-2.5e+3,true,false,null,\"\\u00e9\\n\"],\"b\":{}}", 1, 0);
+    run++; fail+=t_jsonValidate(" [ ] ", 1, 0);
+    run++; fail+=t_jsonValidate("-0.0E-1", 1, 0);
+    run++; fail+=t_jsonValidate("\"caf\xc3\xa9 \xf0\x9d\x84\x9e\"", 1, 0);
+    run++; fail+=t_jsonValidate("", 0, 0);
+    run++; fail+=t_jsonValidate("{\"a\":1,}", 0, 7);
+    run++; fail+=t_jsonValidate("[1,2", 0, 4);
+    run++; fail+=t_jsonValidate("[1,2}", 0, 4);
+    run++; fail+=t_jsonValidate("{\"a\" 1}", 0, 5);
+    run++; fail+=t_jsonValidate("{a:1}", 0, 1);
+    run++; fail+=t_jsonValidate("[01]", 0, 2);
+    run++; fail+=t_jsonValidate("[1.]", 0, 1);
+    run++; fail+=t_jsonValidate("[tru]", 0, 1);
+    run++; fail+=t_jsonValidate("1 2", 0, 2);
+    run++; fail+=t_jsonValidate("\"a\\x\"", 0, 2);
+    run++; fail+=t_jsonValidate("\"a\tb\"", 0, 2);
+    run++; fail+=t_jsonValidate("\"\xc3\"", 0, 1);      // cut sequence
+    run++; fail+=t_jsonValidate("\"\xc0\xaf\"", 0, 1);  // overlong
+    run++; fail+=t_jsonValidate("\"\xed\xa0\x80\"", 0, 1); // surrogate
+    run++; fail+=t_jsonValidate("\xc3\xa9", 0, 0);
+    // across the 32 byte blocks: a number, an escape and a UTF-8 sequence
+    run++; fail+=t_jsonValidate("[1234567890123456789012345678901234567890.5e+10]", 1, 0);
+    run++; fail+=t_jsonValidate("[\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\n\"]", 1, 0);
+    run++; fail+=t_jsonValidate("[\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaa\xc3\xa9\"]", 1, 0);
+    run++; fail+=t_jsonValidate("[12345678901234567890123456789012345678x]", 0, 39);
+    // string bytes and grammar bytes of one block fail in text order
+    run++; fail+=t_jsonValidate("[\"a\\q\" 1]", 0, 3);
+    run++; fail+=t_jsonValidate("[1 2, \"\\q\"]", 0, 3);
+
+    printf("jsonExtractSpanTrusted(%s):\n", json);
+    run++; fail+=expect_num(jsonExtractSpanTrusted(json, strlen(json), "k", &span), 1, "k");
+    run++; fail+=t_jsonSpan(&span, 22, 12, JSON_ARRAY, "k span");
+    run++; fail+=expect_num(jsonExtractSpanTrusted(json, strlen(json), "y", &span), 0, "y");
+    // the closing quote of "a" and the opening quote of ":x" look like the name ":"
+    run++; fail+=expect_num(jsonExtractSpanTrusted("{\"a\":\":x\"}", 10, ":", &span), 0, "no :");
+    run++; fail+=expect_num(jsonExtractSpanTrusted("{\"a\":\":x\",\":\":1}", 16, ":", &span), 1, ":");
+    run++; fail+=t_jsonSpan(&span, 14, 1, JSON_NUMBER, ": span");
+    run++; fail+=expect_num(jsonExtractSpanTrusted("{\"a\":\"\\\"k\\\": 1\",\"k\":2}", 22, "k", &span), 1, "k in string");
+    run++; fail+=t_jsonSpan(&span, 20, 1, JSON_NUMBER, "k span");
+    printf("jsonIndexListSpanTrusted(%s):\n", list);
+    run++; fail+=expect_num(jsonIndexListSpanTrusted(list, strlen(list), 2, &span), 1, "2");
+    run++; fail+=t_jsonSpan(&span, 11, 11, JSON_ARRAY, "2 span");
+    run++; fail+=expect_num(jsonIndexListSpanTrusted(list, strlen(list), 3, &span), 1, "3");
+    run++; fail+=t_jsonSpan(&span, 24, 5, JSON_STRING, "3 span");
+    run++; fail+=expect_num(jsonIndexListSpanTrusted(list, strlen(list), 4, &span), 0, "4");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int test_jsonDom() {
+    int run=0, fail=0;
+    char *json = "{\"a\": [1, -2.5e3, \"x\\ny\"], \"b\\u00e9\": {\"c\": true, \"d\": null}, \"e\": {}}";
+    char arena[1024];
+    jsonDom dom;
+    const jsonNode *root, *a, *node;
+
+    printf("jsonDomParse(%s):\n", json);
+    jsonDomInit(&dom, arena, sizeof(arena));
+    root = jsonDomParse(&dom, json, strlen(json));
+    run++; fail+=expect_num(root!=NULL, 1, "parsed");
+    if (!root) return fail;
+    run++; fail+=expect_num(root->type, JSON_OBJECT, "root type");
+    run++; fail+=expect_num(root->count, 3, "root count");
+    run++; fail+=expect_num(dom.count, 9, "nodes");
+    a = jsonDomGet(&dom, root, "a");
+    run++; fail+=expect_num(a ? a->count : -1, 3, "a count");
+    node = jsonDomIndex(&dom, a, 1);
+    run++; fail+=expect_str(node ? (char *)node->value : "", "-2.5e3", "a[1]");
+    node = jsonDomIndex(&dom, a, 2);
+    run++; fail+=expect_str(node ? (char *)node->value : "", "x\ny", "a[2] unescaped");
+    run++; fail+=expect_num(jsonDomIndex(&dom, a, 3)==NULL, 1, "a[3]");
+    node = jsonDomGet(&dom, jsonDomGet(&dom, root, "b\xc3\xa9"), "c");
+    run++; fail+=expect_num(node ? node->type : -1, JSON_TRUE, "b.c");
+    node = jsonDomGet(&dom, root, "e");
+    run++; fail+=expect_num(node && !jsonDomChild(node), 1, "e empty");
+    run++; fail+=expect_num(jsonDomGet(&dom, root, "x")==NULL, 1, "missing");
+    // iterate members
+    char keys[64] = "";
+    for (node = jsonDomChild(root); node; node = jsonDomNext(&dom, node)) strcat(keys, node->key);
+    run++; fail+=expect_str(keys, "ab\xc3\xa9" "e", "member keys");
+
+    // second document in the same arena, errors leave it unchanged
+    int count = dom.count;
+    run++; fail+=expect_num(jsonDomParse(&dom, "[1,]", 4)==NULL, 1, "invalid");
+    run++; fail+=expect_num(dom.error, 1, "invalid error");
+    run++; fail+=expect_num((int)dom.error_offset, 3, "invalid offset");
+    run++; fail+=expect_num(dom.count, count, "invalid keeps nodes");
+    node = jsonDomParse(&dom, "\"s\"", 3);
+    run++; fail+=expect_str(node ? (char *)node->value : "", "s", "scalar root");
+    run++; fail+=expect_str((char *)jsonDomGet(&dom, root, "a")->key, "a", "first still there");
+    jsonDomInit(&dom, arena, 64);
+    run++; fail+=expect_num(jsonDomParse(&dom, json, strlen(json))==NULL, 1, "full");
+    run++; fail+=expect_num(dom.error, -1, "full error");
+    run++; fail+=expect_num(dom.count, 0, "full rolls back");
+    jsonDomReset(&dom);
+    run++; fail+=expect_num(jsonDomParse(&dom, "[]", 2)!=NULL, 1, "after reset");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int test_jsonBin() {
+    int run=0, fail=0;
+    char *json = "{\"b\": [1, 300, -70000, 5000000000, 2.5, \"x\\u00e9\"], \"a\": {\"z\": null, \"y\": true}, "
+        "\"b\": 0, \"\": false}";
+    char bin[256], out[256];
+    jsonSpan root, span, key;
+    jsonValue value;
+    long len;
+
+    printf("jsonBinEncode(%s):\n", json);
+    len = jsonBinEncode(json, strlen(json), bin, sizeof(bin));
+    run++; fail+=expect_num(len>0 && len<(long)strlen(json), 1, "encoded, smaller");
+    run++; fail+=expect_num(jsonBinRoot(bin, len, &root), 1, "root");
+    run++; fail+=expect_num(jsonBinCount(bin, &root), 4, "count");
+    len = jsonBinDecode(bin, &root, out, sizeof(out));
+    run++; fail+=expect_num((int)len, (int)strlen(out), "decode length");
+    run++; fail+=expect_str(out, "{\"b\":[1,300,-70000,5000000000,2.5,\"x\xc3\xa9\"],\"a\":{\"z\":null,\"y\":true},"
+        "\"b\":0,\"\":false}", "decode");
+    run++; fail+=expect_num(jsonBinGet(bin, &root, "b", &span), 1, "get b");
+    run++; fail+=expect_num(span.type, JSON_ARRAY, "first b wins");
+    run++; fail+=expect_num(jsonBinIndex(bin, &span, 3, &span), 1, "b[3]");
+    run++; fail+=expect_num(jsonBinValue(bin, &span, &value), JSON_NUMBER, "b[3] type");
+    run++; fail+=expect_num(value.is_int && (value.int_value==5000000000LL), 1, "b[3] value");
+    jsonBinGet(bin, &root, "b", &span);
+    jsonBinIndex(bin, &span, 5, &span);
+    jsonBinValue(bin, &span, &value);
+    run++; fail+=expect_num((int)value.span.len, 3, "b[5] unescaped");
+    run++; fail+=expect_num(jsonBinGet(bin, &root, "", &span), 1, "get empty name");
+    run++; fail+=expect_num(span.type, JSON_FALSE, "empty name value");
+    run++; fail+=expect_num(jsonBinGet(bin, &root, "c", &span), 0, "missing");
+    run++; fail+=expect_num(jsonBinMember(bin, &root, 1, &key, &span), 1, "member 1");
+    run++; fail+=expect_num(key.len==1 && bin[key.offset]=='a', 1, "member 1 key");
+    jsonBinGet(bin, &span, "y", &span);
+    run++; fail+=expect_num(span.type, JSON_TRUE, "a.y");
+    run++; fail+=expect_num((int)jsonBinDecode(bin, &root, out, 8), 80, "cut length");
+    run++; fail+=expect_str(out, "{\"b\":[1", "cut");
+    run++; fail+=expect_num((int)jsonBinEncode(json, strlen(json), bin, 16), -1, "no room");
+    run++; fail+=expect_num((int)jsonBinEncode("[1,]", 4, bin, sizeof(bin)), 0, "invalid");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int t_jsonMinifyWrite(void *ctx, const char *data, size_t len) {
+    strncat(ctx, data, len);
+    return 1;
+}
+
+int test_jsonMinify() {
+    int run=0, fail=0;
+    char *json = "{ \"a b\\\\\" : [1, \"x\\\" y\" ],\n  \"c\\\\\":\t\"\\\\\" }";
+    char *expected = "{\"a b\\\\\":[1,\"x\\\" y\"],\"c\\\\\":\"\\\\\"}";
+    char out[256], buff[256];
+    size_t len = strlen(json), i, n;
+    jsonMinify minify;
+
+    printf("Testing jsonMinify\n");
+    run++; fail+=expect_str(jsonRemoveSpacing(json, out), expected, "escaped backslash before quote");
+
+    // every split point gives the same output
+    for (i=0; i<=len; i++) {
+        jsonMinifyInit(&minify, NULL, NULL);
+        strcpy(buff, json);
+        n = jsonMinifyChunk(&minify, buff, i, buff);
+        n += jsonMinifyChunk(&minify, buff+i, len-i, buff+n);
+        buff[n] = '\0';
+        if (strcmp(buff, expected)!=0) break;
+    }
+    run++; fail+=expect_num((int)i, (int)len+1, "split anywhere");
+    run++; fail+=expect_num(jsonMinifyEnd(&minify), 1, "ended outside string");
+
+    // byte at a time through the callback
+    out[0] = '\0';
+    jsonMinifyInit(&minify, t_jsonMinifyWrite, out);
+    for (i=0; i<len; i++) jsonMinifyWrite(&minify, json+i, 1);
+    run++; fail+=expect_str(out, expected, "write byte at a time");
+
+    jsonMinifyInit(&minify, NULL, NULL);
+    jsonMinifyChunk(&minify, "[\"a \\", 5, buff);
+    run++; fail+=expect_num(minify.in_string && minify.escaped, 1, "state carried");
+    run++; fail+=expect_num(jsonMinifyEnd(&minify), 0, "ended inside string");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+int t_jsonProject(char *json, int deny, int step, char *expected, char *name) {
+    const char *keys[] = {"id", "a\\\"b", "tags"};
+    char out[512];
+    size_t len = strlen(json), i;
+    jsonProject project;
+
+    out[0] = '\0';
+    jsonProjectInit(&project, keys, 3, deny, t_jsonMinifyWrite, out);
+    for (i=0; i<len; i+=step) jsonProjectWrite(&project, json+i, (len-i<step) ? len-i : step);
+    if (!jsonProjectEnd(&project)) strcat(out, "<error>");
+    return expect_str(out, expected, name);
+}
+
+int test_jsonProject() {
+    int run=0, fail=0, step;
+    char *json = "{ \"id\" : 7, \"skip\": {\"id\": [1, \"}\"]}, \"a\\\"b\":\"x\\\\\",\n"
+        "  \"tags\": [ \"p\", {\"q\" : null} ], \"zz\": \"\\\"\" }";
+
+    printf("Testing jsonProject\n");
+    for (step=1; step<=(int)strlen(json); step++) {
+        if (t_jsonProject(json, 0, step, "{\"id\":7,\"a\\\"b\":\"x\\\\\",\"tags\":[ \"p\", {\"q\" : null} ]}", "allow")) break;
+    }
+    run++; fail+=expect_num(step, (int)strlen(json)+1, "allow, any chunk size");
+    run++; fail+=t_jsonProject(json, 1, 5, "{\"skip\":{\"id\": [1, \"}\"]},\"zz\":\"\\\"\"}", "deny");
+    run++; fail+=t_jsonProject("{\"id\":1,\"x\":2}\n{\"x\":3}\n[1]\n", 0, 4, "{\"id\":1}\n{}\n[1]\n", "lines");
+    run++; fail+=t_jsonProject("\"id\" 12 ", 0, 1, "\"id\" 12 ", "root scalars pass");
+    run++; fail+=t_jsonProject("{\"id\":1,}", 0, 3, "{\"id\":1<error>", "invalid");
+    run++; fail+=t_jsonProject("{\"id\":1", 0, 3, "{\"id\":1<error>", "truncated");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+// sums of element offsets and lengths, and the count
+int t_jsonSplitElement(void *ctx, const char *json, const jsonSpan *span) {
+    long *sums = ctx;
+    __atomic_fetch_add(&sums[0], (long)span->offset, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&sums[1], (long)span->len * span->type, __ATOMIC_RELAXED);
+    return __atomic_add_fetch(&sums[2], 1, __ATOMIC_RELAXED) != sums[3];
+}
+
+int test_jsonSplitArray() {
+    int run=0, fail=0, i;
+    char *items[] = { "\"a\\\\\"", "{\"b\": [1, \"],[\"]}", "\"\\\"],\"", " -2.5 ", "[[{}], \"\\\\\\\"\"]" };
+    size_t size = 4 << 20, len = 0;
+    char *json = malloc(size);
+    long sums[4] = {0}, expect[3] = {0};
+    jsonCursor cursor;
+    jsonSpan span;
+
+    printf("Testing jsonSplitArray\n");
+    // ~3MB so that it splits into several chunks
+    json[len++] = '[';
+    for (i=0; len < size - 64; i++) {
+        len += sprintf(json+len, "%s%s", (i) ? ",\n" : "", items[i % 5]);
+    }
+    json[len++] = ']';
+    jsonListInit(&cursor, json, len);
+    while (jsonListNext(&cursor, &span)) {
+        expect[0] += span.offset; expect[1] += (long)span.len * span.type; expect[2]++;
+    }
+    run++; fail+=expect_num((int)jsonSplitArray(json, len, 8, t_jsonSplitElement, sums), (int)expect[2], "count");
+    run++; fail+=expect_num(sums[0]==expect[0] && sums[1]==expect[1] && sums[2]==expect[2], 1, "same spans as serial");
+    sums[0] = sums[1] = sums[2] = 0;
+    run++; fail+=expect_num((int)jsonSplitArray(json, len, 1, t_jsonSplitElement, sums), (int)expect[2], "one thread");
+    run++; fail+=expect_num(sums[0]==expect[0] && sums[1]==expect[1], 1, "one thread spans");
+    sums[0] = sums[1] = sums[2] = 0;
+    run++; fail+=expect_num((int)jsonSplitArray(json, len, 1 << 20, t_jsonSplitElement, sums), (int)expect[2], "threads clamped");
+    run++; fail+=expect_num(sums[0]==expect[0] && sums[1]==expect[1], 1, "clamped spans");
+    sums[0] = sums[1] = sums[2] = 0; sums[3] = 10;
+    run++; fail+=expect_num(jsonSplitArray(json, len, 8, t_jsonSplitElement, sums) < expect[2], 1, "stop early");
+    json[len-1] = ' ';
+    run++; fail+=expect_num((int)jsonSplitArray(json, len, 8, t_jsonSplitElement, sums), -1, "not closed");
+    free(json);
+
+    sums[3] = 0;
+    run++; fail+=expect_num((int)jsonSplitArray(" [ ] ", 5, 4, t_jsonSplitElement, sums), 0, "empty");
+    run++; fail+=expect_num((int)jsonSplitArray("[1,,2]", 6, 4, t_jsonSplitElement, sums), -1, "empty element");
+    run++; fail+=expect_num((int)jsonSplitArray("{\"a\":1}", 7, 4, t_jsonSplitElement, sums), -1, "not an array");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
+
+// events as text: {=object [=array k:key s:string n:number t f 0=null,
+// depth before each, '+' after a partial piece. "!" = stop here
+int t_jsonSaxEvent(void *ctx, const jsonEvent *event) {
+    char *out = ctx, *end = out + strlen(out);
+    const char *names = " {}[]ksntf0";
+    end += sprintf(end, "%d%c", event->depth, names[event->type]);
+    if ((event->type>=JSON_EVENT_KEY) && (event->type<=JSON_EVENT_NUMBER)) {
+        end += sprintf(end, ":%.*s", (event->len>8) ? 8 : (int)event->len, event->data);
+    }
+    strcpy(end, (event->partial) ? "+ " : " ");
+    return !strstr(out, "!");
+}
+
+// counts events, stops at the end of a list
+int t_jsonSaxStop(void *ctx, const jsonEvent *event) {
+    (*(int *)ctx)++;
+    return (event->type!=JSON_EVENT_ARRAY_END);
+}
+
+// feed json in pieces of step bytes; returns 1 if complete, -1 on an error
+int t_jsonSax(char *json, size_t step, char *out) {
+    size_t len = strlen(json), i;
+    jsonSax sax;
+    out[0] = '\0';
+    jsonSaxInit(&sax, t_jsonSaxEvent, out);
+    for (i=0; i<len; i+=step) {
+        if (!jsonSaxWrite(&sax, json+i, (len-i<step) ? len-i : step)) return -sax.error_offset - 1;
+    }
+    return (jsonSaxEnd(&sax)) ? 1 : -sax.error_offset - 1;
+}
+
+int test_jsonSax() {
+    int run=0, fail=0;
+    size_t step;
+    char out[4096], first[4096];
+    char long_string[700], long_number[JSON_SAX_BUFFER+4];
+    size_t i;
+    int count = 0;
+    char *json = "{\"a\": [1, -2.5e3, \"x\\\"y\"], \"b\": {\"c\": null, \"d\": [true, false, {}]}, \"e\": []}";
+
+    printf("Testing jsonSax\n");
+    run++; fail+=expect_num(t_jsonSax(json, strlen(json), out), 1, "whole");
+    strcpy(first, out);
+    run++; fail+=expect_num(strcmp(first, "0{ 1k:a 1[ 2n:1 2n:-2.5e3 2s:x\\\"y 1] 1k:b 1{ 2k:c 20 2k:d 2[ 3t 3f 3{ 3} 2] 1} 1k:e 1[ 1] 0} "), 0, "events");
+    for (step=1; step<strlen(json); step++) {
+        t_jsonSax(json, step, out);
+        if (strcmp(out, first)!=0) break;
+    }
+    run++; fail+=expect_num((int)step, (int)strlen(json), "same events for any chunk size");
+
+    // a long string across chunks comes in pieces
+    memset(long_string, 'x', sizeof(long_string));
+    long_string[0] = '"';
+    strcpy(long_string + sizeof(long_string) - 2, "\"");
+    run++; fail+=expect_num(t_jsonSax(long_string, 100, out), 1, "long string");
+    run++; fail+=expect_str(out, "0s:xxxxxxxx+ 0s:xxxxxxxx+ 0s:xxxxxxxx ", "long string pieces");
+    run++; fail+=expect_num(t_jsonSax(long_string, 1000, out), 1, "long string one chunk");
+    run++; fail+=expect_str(out, "0s:xxxxxxxx ", "in place in one chunk");
+
+    run++; fail+=expect_num(t_jsonSax("1 [2]\n{\"a\":3} 12", 3, out), 1, "documents back to back");
+    run++; fail+=expect_str(out, "0n:1 0[ 1n:2 0] 0{ 1k:a 1n:3 0} 0n:12 ", "documents");
+    run++; fail+=expect_num(t_jsonSax("[1, 2}", 2, out), -6, "error offset");
+    run++; fail+=expect_num(t_jsonSax("[1, tru]", 3, out), -5, "bad word offset");
+    run++; fail+=expect_num(t_jsonSax("{\"a\":1", 3, out), -7, "incomplete");
+    run++; fail+=expect_num(t_jsonSax("[\"a\x01\"]", 3, out), -4, "control byte");
+    strcpy(out, "!");
+    jsonSax sax;
+    jsonSaxInit(&sax, t_jsonSaxEvent, out);
+    run++; fail+=expect_num(jsonSaxWrite(&sax, "[1,2]", 5), 0, "stopped");
+    run++; fail+=expect_num(sax.error, -1, "stopped by callback");
+    jsonSaxInit(&sax, t_jsonSaxStop, &count);
+    run++; fail+=expect_num(jsonSaxWrite(&sax, "[1] [2]", 7), 0, "stopped at ]");
+    run++; fail+=expect_num(count, 3, "no events after ]");
+
+    // numbers over JSON_SAX_BUFFER fail alike in one chunk or split
+    memset(long_number, '1', sizeof(long_number));
+    long_number[0] = '[';
+    strcpy(long_number + 1 + JSON_SAX_BUFFER, "]");
+    run++; fail+=expect_num(t_jsonSax(long_number, 100, out), 1, "longest number split");
+    run++; fail+=expect_num(t_jsonSax(long_number, 1000, out), 1, "longest number");
+    strcpy(long_number + 1 + JSON_SAX_BUFFER, "1]");
+    run++; fail+=expect_num(t_jsonSax(long_number, 1000, out), -2, "long number");
+    for (step=1; step<=JSON_SAX_BUFFER+2; step++) {
+        jsonSaxInit(&sax, t_jsonSaxEvent, out);
+        out[0] = '\0';
+        for (i=0; i<JSON_SAX_BUFFER+3; i+=step) {
+            if (!jsonSaxWrite(&sax, long_number+i, (JSON_SAX_BUFFER+3-i<step) ? JSON_SAX_BUFFER+3-i : step)) break;
+        }
+        if ((sax.error!=2) || (sax.error_offset!=1)) break;
+    }
+    run++; fail+=expect_num((int)step, JSON_SAX_BUFFER+3, "long number split anywhere");
+
+    printf("Tests run: %d, failed: %d\n\n", run, fail);
+    return fail;
+}
@@ -0,0 +1,43 @@
+/* json_minify.c  */
+/* Remove spacing outside strings from JSON on stdin (or a file) to stdout.
+
+   usage: json_minify [file]
+
+   Input is read in fixed size blocks and fed to jsonMinifyWrite, so memory
+   use does not depend on the input size. Exits 1 on a read/write error or
+   when the input ends inside a string.
+*/
+
+#include <stdio.h>
+#include "lightcjson.h"
+
+#define READ_SIZE (1 << 16)
+
+static int write_out(void *ctx, const char *data, size_t len) {
+  return fwrite(data, 1, len, ctx)==len;
+}
+
+int main(int argc, char **argv) {
+  static char buf[READ_SIZE];
+  FILE *in = stdin;
+  jsonMinify minify;
+  size_t n;
+
+  if (argc>2) {
+    fprintf(stderr, "usage: json_minify [file]\n");
+    return 2;
+  }
+  if ((argc==2) && !(in = fopen(argv[1], "rb"))) { perror(argv[1]); return 1; }
+
+  jsonMinifyInit(&minify, write_out, stdout);
+  while ((n = fread(buf, 1, sizeof(buf), in))>0) {
+    if (!jsonMinifyWrite(&minify, buf, n)) break;
+  }
+  if (ferror(in)) { perror("read"); return 1; }
+  if (minify.error || (fflush(stdout)!=0)) { perror("write"); return 1; }
+  if (!jsonMinifyEnd(&minify)) {
+    fprintf(stderr, "json_minify: input ends inside a string\n");
+    return 1;
+  }
+  return 0;
+}
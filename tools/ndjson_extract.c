@@ -0,0 +1,225 @@
+/* ndjson_extract.c  */
+/* Extract fields from a JSON-Lines file with a pool of worker threads.
+
+   usage: ndjson_extract [-t threads] [-f tsv|ndjson] [-p] file key [key...]
+
+   The input is mmapped and cut into chunks on line boundaries. Workers
+   take chunks in turn and write the selected fields of every line to the
+   chunk's own output buffer; the main thread writes finished chunks in
+   input order, so output lines match input lines.
+
+   -t  number of worker threads (default: online CPUs)
+   -f  tsv (default): one tab separated field per key, strings without
+       their quotes (still JSON escaped, so never holding a tab/newline),
+       missing keys empty. ndjson: {"key":value,...}, missing keys left out
+   -p  keys are paths ("a.b[3].c" or "/a/b/3/c") instead of top level keys
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "lightcjson.h"
+
+#define CHUNK_SIZE (4 << 20)
+#define CHUNK_WINDOW 4 // chunks in flight per thread, bounds buffered output
+
+typedef struct {
+  char *data;
+  size_t len, size;
+} outbuf;
+
+typedef struct {
+  const char *start, *end;
+  outbuf out;
+  int done;
+} chunk;
+
+typedef struct {
+  const char *keys[JSON_MANY_MAX_KEYS];
+  char *quoted_keys[JSON_MANY_MAX_KEYS];  // "key": for ndjson
+  int key_count;
+  int ndjson, paths;
+
+  chunk *chunks;
+  int chunk_count;
+  int next_chunk;         // next chunk to parse
+  int next_write;         // next chunk to write
+  int window;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+} job;
+
+static void out_put(outbuf *out, const char *data, size_t len) {
+  if (out->len + len > out->size) {
+    size_t size = (out->size) ? out->size*2 : 1 << 16;
+    while (size < out->len + len) size *= 2;
+    out->data = realloc(out->data, size);
+    if (!out->data) { perror("realloc"); exit(1); }
+    out->size = size;
+  }
+  memcpy(out->data + out->len, data, len);
+  out->len += len;
+}
+
+static void extract_line(job *jb, const char *line, size_t len, outbuf *out) {
+  jsonSpan spans[JSON_MANY_MAX_KEYS];
+  int i, first = 1;
+
+  if (jb->paths) {
+    for (i=0; i<jb->key_count; i++) {
+      if (!jsonQuerySpan(line, len, jb->keys[i], &spans[i])) spans[i].type = JSON_NONE;
+    }
+  } else {
+    jsonExtractMany(line, len, jb->keys, spans, jb->key_count);
+  }
+  if (jb->ndjson) out_put(out, "{", 1);
+  for (i=0; i<jb->key_count; i++) {
+    const char *value = line + spans[i].offset;
+    size_t value_len = spans[i].len;
+    if (jb->ndjson) {
+      if (spans[i].type==JSON_NONE) continue;
+      if (!first) out_put(out, ",", 1);
+      out_put(out, jb->quoted_keys[i], strlen(jb->quoted_keys[i]));
+      out_put(out, value, value_len);
+    } else {
+      if (i>0) out_put(out, "\t", 1);
+      if (spans[i].type==JSON_NONE) continue;
+      if ((spans[i].type==JSON_STRING) && (value_len>=2)) { value++; value_len -= 2; }
+      out_put(out, value, value_len);
+    }
+    first = 0;
+  }
+  out_put(out, (jb->ndjson) ? "}\n" : "\n", (jb->ndjson) ? 2 : 1);
+}
+
+static void extract_chunk(job *jb, chunk *ch) {
+  const char *ptr = ch->start;
+  while (ptr<ch->end) {
+    const char *line_end = memchr(ptr, '\n', ch->end-ptr);
+    if (!line_end) line_end = ch->end;
+    size_t len = line_end - ptr;
+    if ((len>0) && (ptr[len-1]=='\r')) len--;
+    if (len>0) extract_line(jb, ptr, len, &ch->out);
+    ptr = line_end+1;
+  }
+}
+
+static void *worker(void *arg) {
+  job *jb = arg;
+  while (1) {
+    pthread_mutex_lock(&jb->lock);
+    while ((jb->next_chunk < jb->chunk_count) &&
+        (jb->next_chunk >= jb->next_write + jb->window)) {
+      pthread_cond_wait(&jb->changed, &jb->lock);
+    }
+    int i = jb->next_chunk++;
+    pthread_mutex_unlock(&jb->lock);
+    if (i >= jb->chunk_count) return NULL;
+
+    extract_chunk(jb, &jb->chunks[i]);
+
+    pthread_mutex_lock(&jb->lock);
+    jb->chunks[i].done = 1;
+    pthread_cond_broadcast(&jb->changed);
+    pthread_mutex_unlock(&jb->lock);
+  }
+}
+
+static int usage(void) {
+  fprintf(stderr, "usage: ndjson_extract [-t threads] [-f tsv|ndjson] [-p] file key [key...]\n");
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  job jb;
+  int opt, threads = (int)sysconf(_SC_NPROCESSORS_ONLN), i;
+  struct stat st;
+
+  memset(&jb, 0, sizeof(jb));
+  while ((opt = getopt(argc, argv, "t:f:p"))!=-1) {
+    switch (opt) {
+    case 't': threads = atoi(optarg); break;
+    case 'f':
+      if (strcmp(optarg, "ndjson")==0) jb.ndjson = 1;
+      else if (strcmp(optarg, "tsv")!=0) return usage();
+      break;
+    case 'p': jb.paths = 1; break;
+    default: return usage();
+    }
+  }
+  if ((argc-optind<2) || (argc-optind-1>JSON_MANY_MAX_KEYS)) return usage();
+  if (threads<1) threads = 1;
+  jb.key_count = argc-optind-1;
+  for (i=0; i<jb.key_count; i++) {
+    const char *key = argv[optind+1+i];
+    int len = jsonEscapeTo(key, strlen(key), NULL, 0);
+    jb.keys[i] = key;
+    jb.quoted_keys[i] = malloc(len+4);
+    if (!jb.quoted_keys[i]) { perror("malloc"); return 1; }
+    jb.quoted_keys[i][0] = '"';
+    jsonEscapeTo(key, strlen(key), jb.quoted_keys[i]+1, len+1);
+    strcpy(jb.quoted_keys[i]+1+len, "\":");
+  }
+
+  int fd = open(argv[optind], O_RDONLY);
+  if ((fd<0) || (fstat(fd, &st)<0)) { perror(argv[optind]); return 1; }
+  size_t size = st.st_size;
+  const char *data = "";
+  if (size>0) {
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data==MAP_FAILED) { perror("mmap"); return 1; }
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+  }
+
+  // cut into chunks just after a newline
+  jb.chunks = calloc(size/CHUNK_SIZE + 1, sizeof(chunk));
+  if (!jb.chunks) { perror("calloc"); return 1; }
+  const char *ptr = data, *end = data + size;
+  while (ptr<end) {
+    const char *cut = (end-ptr > CHUNK_SIZE) ? ptr + CHUNK_SIZE : end;
+    if (cut<end) {
+      const char *nl = memchr(cut, '\n', end-cut);
+      cut = (nl) ? nl+1 : end;
+    }
+    jb.chunks[jb.chunk_count].start = ptr;
+    jb.chunks[jb.chunk_count].end = cut;
+    jb.chunk_count++;
+    ptr = cut;
+  }
+
+  jb.window = threads * CHUNK_WINDOW;
+  pthread_mutex_init(&jb.lock, NULL);
+  pthread_cond_init(&jb.changed, NULL);
+  pthread_t tids[threads];
+  for (i=0; i<threads; i++) {
+    int err = pthread_create(&tids[i], NULL, worker, &jb);
+    if (err) { // workers take chunks as they go, fewer of them still finish
+      if (!i) { fprintf(stderr, "pthread_create: %s\n", strerror(err)); return 1; }
+      threads = i;
+    }
+  }
+
+  // write chunks in order as they finish
+  for (i=0; i<jb.chunk_count; i++) {
+    pthread_mutex_lock(&jb.lock);
+    while (!jb.chunks[i].done) pthread_cond_wait(&jb.changed, &jb.lock);
+    pthread_mutex_unlock(&jb.lock);
+    outbuf *out = &jb.chunks[i].out;
+    if (out->len && (fwrite(out->data, 1, out->len, stdout)!=out->len)) {
+      perror("write"); return 1;
+    }
+    free(out->data);
+    pthread_mutex_lock(&jb.lock);
+    jb.next_write = i+1;
+    pthread_cond_broadcast(&jb.changed);
+    pthread_mutex_unlock(&jb.lock);
+  }
+  for (i=0; i<threads; i++) pthread_join(tids[i], NULL);
+  if (fflush(stdout)!=0) { perror("write"); return 1; }
+  return 0;
+}